@@ -22,6 +22,9 @@
 #include "ses_adc.h"
 #include "ses_common.h"
 #include "ses_lcd.h"
+#include "ses_framebuffer.h"
+#include "ses_format.h"
+#include <avr/sleep.h>
 
 /* DEFINES & MACROS **********************************************************/
 #define TEMP_SENSOR_PORT            PORTF
@@ -49,6 +52,7 @@
 #define ADC_Enable_PIN               ADEN
 #define ADC_Auto_Trigger_Enable      ADATE
 #define ADC_START_CONVERSION         ADSC
+#define ADC_Interrupt_Enable         ADIE
 
 #define ADC_PRESCALER                (~(1<ADPS2))&((1<<ADPS1)|(1<ADPS0))
 
@@ -68,6 +72,44 @@
 #define ADC_TEMP_RAW_MIN             482
 #define ADC_TEMP_FACTOR              100
 
+/* PRIVATE VARIABLES *********************************************************/
+
+static volatile bool adcConversionDone = false; /* set by ADC_vect in noise reduction reads */
+static bool noiseReduction = false; /* sensor reads use adc_readNoiseReduced */
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static uint16_t adc_readSensor(uint8_t adc_channel) {
+
+	if (noiseReduction) {
+		return adc_readNoiseReduced(adc_channel);
+	}
+	return adc_read(adc_channel);
+}
+
+/*
+ * integer square root, rounded down
+ */
+static uint16_t adc_sqrt(uint32_t value) {
+
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint16_t) root;
+}
+
 /* FUNCTION DEFINITION *******************************************************/
 
 void adc_init(void) {
@@ -159,9 +201,102 @@ uint8_t adc_getJoystickDirection(void) {
 	}
 }
 
+uint16_t adc_readNoiseReduced(uint8_t adc_channel) {
+
+	uint16_t ADC_RESULT;
+	uint8_t sreg = SREG; /* Variable to save the value of the SREG Register*/
+
+	if (adc_channel >= ADC_NUM) {
+		return ADC_INVALID_CHANNEL;
+	}
+
+	/*
+	 * ADC_vect is needed to wake the CPU up again, without
+	 * global interrupts the busy-wait read is the only option
+	 */
+	if (!(sreg & (1 << SREG_I))) {
+		return adc_read(adc_channel);
+	}
+
+	adc_init();
+
+	ADMUX_REG &= ADMUX_CLEAR;
+	ADMUX_REG |= (adc_channel << ADC_CHANNEL_SELECT_PIN); /*Select the ADC channels that will be used*/
+
+	adcConversionDone = false;
+	ADC_CONTROL_STATUS_REG |= (1 << ADC_Interrupt_Enable);
+
+	/*
+	 * Entering the ADC noise reduction sleep mode starts the conversion
+	 * while the CPU and the I/O clock are halted. The timers clocked from
+	 * clkIO (the scheduler tick, PWM, debounce) stop and cannot wake the
+	 * CPU; only asynchronous sources such as pin change or external
+	 * interrupts can. Their ISR runs and the CPU goes back to sleep while
+	 * the conversion keeps running. Checking the flag and sleeping is done
+	 * with interrupts disabled, sei() delays interrupts by one instruction
+	 * so ADC_vect cannot slip in between the check and sleep_cpu().
+	 */
+	set_sleep_mode(SLEEP_MODE_ADC);
+	cli();
+	while (!adcConversionDone) {
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+		cli();
+	}
+
+	ADC_CONTROL_STATUS_REG &= ~(1 << ADC_Interrupt_Enable);
+	ADC_RESULT = ADC; /* Read the ADC Values, interrupts are still disabled*/
+
+	SREG = sreg; /* Restore global interrupt flag */
+
+	return (ADC_RESULT);
+}
+
+ISR(ADC_vect) {
+	adcConversionDone = true;
+}
+
+void adc_setNoiseReduction(bool enable) {
+	noiseReduction = enable;
+}
+
+uint16_t adc_measureNoise(uint8_t adc_channel, uint16_t samples,
+		bool noiseReduced) {
+
+	uint32_t sum = 0;
+	uint64_t sumOfSquares = 0;
+
+	if (adc_channel >= ADC_NUM || samples < 2) {
+		return 0;
+	}
+
+	for (uint16_t i = 0; i < samples; i++) {
+		uint16_t value = noiseReduced ?
+				adc_readNoiseReduced(adc_channel) : adc_read(adc_channel);
+		sum += value;
+		sumOfSquares += (uint32_t) value * value;
+	}
+
+	/*
+	 * n^2 * variance = n * sum(x^2) - sum(x)^2, scaled by 256 before the
+	 * root gives the deviation with 4 fraction bits
+	 */
+	uint64_t scaledVariance = ((uint64_t) samples * sumOfSquares
+			- (uint64_t) sum * sum) * 256 / ((uint32_t) samples * samples);
+
+	return adc_sqrt((uint32_t) scaledVariance);
+}
+
+uint16_t adc_getLight(void) {
+
+	return adc_readSensor(ADC_LIGHT_CH);
+}
+
 int16_t adc_getTemperature(void) {
 
-	int16_t adc = adc_read(ADC_TEMP_CH);
+	int16_t adc = adc_readSensor(ADC_TEMP_CH);
 	int16_t slope = (ADC_TEMP_MAX - ADC_TEMP_MIN)
 			/ (ADC_TEMP_RAW_MAX - ADC_TEMP_RAW_MIN);
 	int16_t offset = ADC_TEMP_MAX - (ADC_TEMP_RAW_MAX * slope);
@@ -169,22 +304,34 @@ int16_t adc_getTemperature(void) {
 }
 
 void adc_print(void) {
-	lcd_clear();
-	lcd_setCursor(0, 0);
 
-	fprintf(lcdout, "*the Temp=%d C*", adc_getTemperature());
+	/*
+	 * the screen is redrawn in RAM, the flush task of the framebuffer
+	 * sends what changed in small steps (framebuffer_init starts it)
+	 */
+	framebuffer_clear();
+	framebuffer_setCursor(0, 0);
+
+	format_putString_P(framebufferOut, PSTR("*the Temp="));
+	format_putSigned(framebufferOut, adc_getTemperature(), 0, ' ');
+	format_putString_P(framebufferOut, PSTR(" C*"));
+
+	framebuffer_setCursor(1, 1);
 
-	lcd_setCursor(1, 1);
+	//format_putString_P(framebufferOut, PSTR("**the light="));
+	//format_putUnsigned(framebufferOut, adc_getLight(), 0, ' ');
 
-	//fprintf(lcdout, "**the light=%d**", adc_getLight());
+	//framebuffer_setCursor(2, 2);
 
-	//lcd_setCursor(2, 2);
+	format_putString_P(framebufferOut, PSTR("***position="));
+	format_putUnsigned(framebufferOut, adc_getJoystickDirection(), 0, ' ');
 
-	fprintf(lcdout, "***position=%d", adc_getJoystickDirection());
+	framebuffer_setCursor(3, 3);
 
-	lcd_setCursor(3, 3);
+	format_putString_P(framebufferOut, PSTR("*temp raw="));
+	format_putUnsigned(framebufferOut, adc_read(ADC_TEMP_CH), 0, ' ');
 
-	fprintf(lcdout, "*temp raw=%d", adc_read(ADC_TEMP_CH));
+	framebuffer_present();
 
 
 
@@ -48,6 +48,39 @@ void adc_init(void);
  */
 uint16_t adc_read(uint8_t adc_channel);
 
+/**
+ * Read the raw ADC value of the given channel with the conversion done in
+ * ADC noise reduction sleep, waking up on ADC_vect. The CPU sleeps for the
+ * conversion time; other interrupts are served and the CPU sleeps again
+ * until the result is ready. Note that the I/O clock is halted while
+ * sleeping, so timer0 PWM and the scheduler timer pause for the conversion
+ * (about 100 us) and do not wake the CPU.
+ * Falls back to adc_read if global interrupts are disabled.
+ * @adc_channel The channel as element of the ADCChannels enum
+ * @return The raw ADC value
+ */
+uint16_t adc_readNoiseReduced(uint8_t adc_channel);
+
+/**
+ * Selects how adc_getTemperature and adc_getLight convert. Noise reduced
+ * reads are off by default, as every reading pauses the I/O clock.
+ * @enable true to use adc_readNoiseReduced for the sensors
+ */
+void adc_setNoiseReduction(bool enable);
+
+/**
+ * Standard deviation of a number of reads of one channel, to compare the
+ * busy-wait and the noise reduced conversion on the board, e.g.
+ * adc_measureNoise(ADC_TEMP_CH, 1000, false) against
+ * adc_measureNoise(ADC_TEMP_CH, 1000, true).
+ * @adc_channel The channel as element of the ADCChannels enum
+ * @samples number of reads, at least 2
+ * @noiseReduced true to read with adc_readNoiseReduced
+ * @return standard deviation in 1/16 LSB, 0 for invalid arguments
+ */
+uint16_t adc_measureNoise(uint8_t adc_channel, uint16_t samples,
+		bool noiseReduced);
+
 /**
  * Read the current joystick direction
  * @return The direction as element of the JoystickDirections enum
@@ -60,6 +93,12 @@ uint8_t adc_getJoystickDirection();
  */
 int16_t adc_getTemperature();
 
+/**
+ * Read the current light sensor value, see adc_setNoiseReduction
+ * @return The raw ADC value of the light sensor
+ */
+uint16_t adc_getLight();
+
 
 
 
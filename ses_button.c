@@ -22,11 +22,16 @@
 #include <stdbool.h>
 #include "ses_timer.h"
 #include "ses_lcd.h"
+#include "util/atomic.h"
+#include "ses_input.h"
+#include "ses_gpio.h"
 
 /* DEFINES & MACROS **********************************************************/
 
-#define JOYSTICK_PIN         	         7
-#define ROTARY_ENCODER_PIN               6
+#define JOYSTICK_PIN         	         INPUT_JOYSTICK_PIN
+#define ROTARY_ENCODER_PIN               INPUT_ROTARY_BUTTON_PIN
+#define JOYSTICK_BUTTON                  INPUT_BUTTON_PORT, JOYSTICK_PIN
+#define ROTARY_BUTTON                    INPUT_BUTTON_PORT, ROTARY_ENCODER_PIN
 
 #define PIN_CHANGE_INTERRUPT_REGISTER    PCICR
 #define PIN_Change_Interrupt_Enable_0    PCIE0
@@ -34,23 +39,65 @@
 #define PIN_CHANGE_ENABLE_MASK_JOYSTICK  7
 #define PIN_CHANGE_ENABLE_MASK_ROTARY    6
 #define EXTERNAL_INTERRUPT_FLAG_REGISTER EIFR
-#define BUTTON_NUM_DEBOUNCE_CHECKS       5
+#define PIN_CHANGE_FLAG_REGISTER         PCIFR
+#define PIN_Change_Interrupt_Flag_0      PCIF0
+#define BUTTON_WAKEUP_MASK               ((1 << PIN_CHANGE_ENABLE_MASK_JOYSTICK) | (1 << PIN_CHANGE_ENABLE_MASK_ROTARY))
+
+/*
+ * adaptive mode: default number of 5 ms ticks with all buttons released
+ * and stable before timer1 is stopped, gesture_setConfig raises it above
+ * the double click time so a pending click is still reported
+ */
+#define BUTTON_TICK_MS                   5
+#define BUTTON_ADAPTIVE_IDLE_TICKS       100
 
 /* GLOBAL VARIABLES *******************************************************/
 
-volatile pButtonCallback myRotaryCallback = NULL; /* pointer to a fuction to be called when the rotaty is pressed */
-volatile pButtonCallback myJoystickCallback = NULL; /* pointer to a fuction to be called when the joystick is pressed */
+volatile pButtonCallback myPressCallbacks[BUTTON_NUM] = { }; /* called on the debounced press edge of each button */
+volatile pButtonCallback myReleaseCallbacks[BUTTON_NUM] = { }; /* called on the debounced release edge of each button */
+
+volatile pButtonStateCallback myStateCallback = NULL; /* called with the debounced state on every tick */
+
+static volatile uint8_t debouncedState = 0; /* bit i is set while button i is pressed */
 
 bool externalInterrupt = false; /* a flag to give the user the choise the usege of the external interrupt or not */
 
+static bool adaptiveDebouncing = false; /* timer1 only runs while the buttons settle */
+static uint16_t idleTicks = 0; /* quiet ticks in adaptive mode */
+static volatile uint16_t idleTickLimit = BUTTON_ADAPTIVE_IDLE_TICKS; /* quiet ticks before timer1 stops */
+static volatile uint32_t debounceTickCount = 0; /* number of button_checkState calls */
+static volatile uint32_t wakeupCount = 0; /* number of pin change wakeups in adaptive mode */
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+/*
+ * bit i of the result is set while button i is pressed (not debounced),
+ * the snapshot uses the ButtonIds positions for the buttons
+ */
+static uint8_t button_sample(void) {
+
+	return input_getSnapshot() & INPUT_BUTTON_MASK;
+}
+
+/*
+ * enables the pin change interrupt of both buttons, a pending
+ * flag from older edges is cleared first
+ */
+static void button_armWakeup(void) {
+
+	PIN_CHANGE_FLAG_REGISTER = (1 << PIN_Change_Interrupt_Flag_0);
+	PIN_CHANGE_MASK_REGISTER_0 |= BUTTON_WAKEUP_MASK;
+	PIN_CHANGE_INTERRUPT_REGISTER |= (1 << PIN_Change_Interrupt_Enable_0);
+}
+
 /* FUNCTION DEFINITION *******************************************************/
 
 void button_init(bool debouncing) {
 
-	DDR_REGISTER(PORTB) &= ~(1 << JOYSTICK_PIN); /* declare PINB7 is an input*/
-	PORTB |= (1 << JOYSTICK_PIN); /* set the pull up resistor of the Joystick*/
-	DDR_REGISTER(PORTB) &= ~(1 << ROTARY_ENCODER_PIN); /* declare PINB6 is an input*/
-	PORTB |= (1 << ROTARY_ENCODER_PIN); /* set the pull up resistor of the Rotary*/
+	GPIO_MAKE_INPUT(JOYSTICK_BUTTON); /* declare PINB7 is an input*/
+	GPIO_SET(JOYSTICK_BUTTON); /* set the pull up resistor of the Joystick*/
+	GPIO_MAKE_INPUT(ROTARY_BUTTON); /* declare PINB6 is an input*/
+	GPIO_SET(ROTARY_BUTTON); /* set the pull up resistor of the Rotary*/
 
 	if (debouncing) {
 		timer1_start();
@@ -87,13 +134,70 @@ void button_init(bool debouncing) {
 	sei();
 }
 
+void button_initAdaptive(void) {
+
+	GPIO_MAKE_INPUT(JOYSTICK_BUTTON); /* declare PINB7 is an input*/
+	GPIO_SET(JOYSTICK_BUTTON); /* set the pull up resistor of the Joystick*/
+	GPIO_MAKE_INPUT(ROTARY_BUTTON); /* declare PINB6 is an input*/
+	GPIO_SET(ROTARY_BUTTON); /* set the pull up resistor of the Rotary*/
+
+	adaptiveDebouncing = true;
+	idleTicks = 0;
+
+	pTimerCallback callback = &button_checkState;
+	timer1_setCallback(callback);
+
+	/*
+	 * timer1 stays off until the first edge wakes the debouncer up
+	 */
+	button_armWakeup();
+
+	sei();
+}
+
+void button_setAdaptiveIdleTime(uint16_t ms) {
+
+	/*
+	 * one tick more than asked, the timer must outlive the last
+	 * timeout counted by the tick callbacks
+	 */
+	uint16_t ticks = ms / BUTTON_TICK_MS + 1;
+
+	if (ticks < BUTTON_ADAPTIVE_IDLE_TICKS) {
+		ticks = BUTTON_ADAPTIVE_IDLE_TICKS;
+	}
+	idleTickLimit = ticks;
+}
+
+uint32_t button_getDebounceTickCount(void) {
+
+	uint32_t count;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		count = debounceTickCount;
+	}
+	return count;
+}
+
+uint32_t button_getWakeupCount(void) {
+
+	uint32_t count;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		count = wakeupCount;
+	}
+	return count;
+}
+
 bool button_isJoystickPressed(void) {
 
 	/* check that the joystick pin is grounded and
 	 *  then the input can be read as logic low level via PINB
 	 */
 
-	if ((PIN_REGISTER(PORTB) & 1 << JOYSTICK_PIN) == 0) {
+	if (input_getSnapshot() & (1 << INPUT_JOYSTICK)) {
 		return true;
 	} else {
 		return false;
@@ -105,7 +209,7 @@ bool button_isRotaryPressed(void) {
 	 * then the input can be read as logic low level via PINB
 	 */
 
-	if (!(PIN_REGISTER(PORTB) & 1 << ROTARY_ENCODER_PIN) == 0) {
+	if (input_getSnapshot() & (1 << INPUT_ROTARY_BUTTON)) {
 		return true;
 	} else {
 		return false;
@@ -119,86 +223,140 @@ ISR(PCINT0_vect) {
 	 * the mask register contains a 1 and to check if one of the button values cheanged
 	 */
 
-	if (button_isJoystickPressed() && (myJoystickCallback != NULL)
+	pButtonCallback callback;
+	uint8_t sample;
+
+	if (adaptiveDebouncing) {
+
+		/*
+		 * the first edge starts the debounce sampling, the following
+		 * bounces are not needed and the pin change interrupt is masked
+		 * until the buttons have settled again
+		 */
+		PIN_CHANGE_MASK_REGISTER_0 &= ~BUTTON_WAKEUP_MASK;
+		wakeupCount++;
+		idleTicks = 0;
+		timer1_start();
+		return;
+	}
+
+	/* the edge is newer than the last sampler tick */
+	sample = input_refresh() & INPUT_BUTTON_MASK;
+
+	if ((sample & (1 << BUTTON_JOYSTICK))
+			&& (callback = myPressCallbacks[BUTTON_JOYSTICK]) != NULL
 			&& (PIN_CHANGE_MASK_REGISTER_0
 					& 1 << PIN_CHANGE_ENABLE_MASK_JOYSTICK) != 0) {
-		myJoystickCallback(NULL);
+		callback(NULL);
 
-	} else if (button_isRotaryPressed() && (myRotaryCallback != NULL)
+	} else if ((sample & (1 << BUTTON_ROTARY))
+			&& (callback = myPressCallbacks[BUTTON_ROTARY]) != NULL
 			&& (PIN_CHANGE_MASK_REGISTER_0 & 1 << PIN_CHANGE_ENABLE_MASK_ROTARY)
 					!= 0) {
-		myRotaryCallback(NULL);
+		callback(NULL);
 	}
 
 }
 
-void button_setRotaryButtonCallback(pButtonCallback callback) {
-	myRotaryCallback = callback;
+void button_setPressCallback(uint8_t button, pButtonCallback callback) {
+	if (button < BUTTON_NUM) {
+		myPressCallbacks[button] = callback;
+	}
 }
 
-void button_setJoystickButtonCallback(pButtonCallback callback) {
-	myJoystickCallback = callback;
-
+void button_setReleaseCallback(uint8_t button, pButtonCallback callback) {
+	if (button < BUTTON_NUM) {
+		myReleaseCallbacks[button] = callback;
+	}
 }
 
-void button_checkState(void* checkP) {
-
-	static uint8_t state[BUTTON_NUM_DEBOUNCE_CHECKS] = { };
-	static uint8_t index = 0;
-	static uint8_t debouncedState = 0;
-	uint8_t lastDebouncedState = debouncedState;
+void button_setRotaryButtonCallback(pButtonCallback callback) {
+	button_setPressCallback(BUTTON_ROTARY, callback);
+}
 
-	/*
-	 * each bit in every state byte represents one button
-	 */
-	state[index] = 0;
+void button_setJoystickButtonCallback(pButtonCallback callback) {
+	button_setPressCallback(BUTTON_JOYSTICK, callback);
 
-	if (button_isJoystickPressed()) {
-		state[index] |= 1;
-	}
+}
 
-	if (button_isRotaryPressed()) {
-		state[index] |= 2;
-	}
+void button_setStateCallback(pButtonStateCallback callback) {
+	myStateCallback = callback;
+}
 
-	index++;
+uint8_t button_getDebouncedState(void) {
+	return debouncedState;
+}
 
-	if (index == BUTTON_NUM_DEBOUNCE_CHECKS) {
-		index = 0;
-	}
+void button_checkState(void* checkP) {
 
-	/* init compare value and compare with ALL reads, only if
-	 * we read BUTTON_NUM_DEBOUNCE_CHECKS consistent "1" in the state
-	 * array, the button at this position is considered pressed
+	/*
+	 * vertical counter: bit i of count0/count1 form a 2 bit counter for
+	 * button i, so all 8 buttons are debounced with the same few logic
+	 * operations. A button changes its debounced state after 4 consecutive
+	 * samples differing from it, any agreeing sample reloads its counter.
 	 */
-
-	uint8_t j = 0xFF;
-
-	for (uint8_t i = 0; i < BUTTON_NUM_DEBOUNCE_CHECKS; i++) {
-		j = j & state[i];
+	static uint8_t count0 = 0xFF;
+	static uint8_t count1 = 0xFF;
+	uint8_t sample = button_sample();
+	uint8_t state = debouncedState;
+	uint8_t changed;
+	uint8_t pressed;
+	uint8_t released;
+
+	debounceTickCount++;
+
+	changed = state ^ sample;
+	count0 = ~(count0 & changed);
+	count1 = count0 ^ (count1 & changed);
+	changed &= count0 & count1; /* counters that rolled over */
+
+	state ^= changed;
+	debouncedState = state;
+
+	pressed = changed & state;
+	released = changed & ~state;
+
+	pButtonStateCallback stateCallback = myStateCallback;
+	if (stateCallback != NULL) {
+		stateCallback(state);
 	}
-	debouncedState = j;
 
-	/* to make sure that the last state
-	 * is different from the current state and that
-	 *  the array started to count again form the first to trigger the new state
+	/*
+	 * edges are rare, a quiet tick leaves the loop immediately
 	 */
-	if (lastDebouncedState != debouncedState) {
+	for (uint8_t i = 0; (pressed | released) != 0; i++) {
 
-		if (debouncedState == 1) {
-			myJoystickCallback(NULL);
+		pButtonCallback callback;
 
+		if ((pressed & 1) && (callback = myPressCallbacks[i]) != NULL) {
+			callback(NULL);
 		}
-		if (debouncedState == 2) {
-			myRotaryCallback(NULL);
-
+		if ((released & 1) && (callback = myReleaseCallbacks[i]) != NULL) {
+			callback(NULL);
 		}
+		pressed >>= 1;
+		released >>= 1;
+	}
 
-		if (debouncedState == 3) {
-			myJoystickCallback(NULL);
-			myRotaryCallback(NULL);
+	if (adaptiveDebouncing) {
+
+		if (state != 0 || sample != state) {
+			idleTicks = 0;
+		} else if (++idleTicks >= idleTickLimit) {
+
+			/*
+			 * arm the wakeup before stopping the timer, an edge after
+			 * arming is pending in PCIF0. An edge between the last
+			 * sample and arming is caught by sampling once more.
+			 */
+			idleTicks = 0;
+			button_armWakeup();
+
+			if ((input_refresh() & INPUT_BUTTON_MASK) != state) {
+				PIN_CHANGE_MASK_REGISTER_0 &= ~BUTTON_WAKEUP_MASK;
+			} else {
+				timer1_stop();
+			}
 		}
-
-		lastDebouncedState = debouncedState;
 	}
 }
@@ -8,13 +8,56 @@
 
 extern bool externalInterrupt;
 
+/* TYPES ********************************************************************/
+
+/**bit positions of the buttons in the debounced state, at most 8
+ */
+enum ButtonIds {
+	BUTTON_JOYSTICK = 0,
+	BUTTON_ROTARY,
+	BUTTON_NUM
+};
+
 /* FUNCTION PROTOTYPES *******************************************************/
+/**
+ * Samples and debounces all buttons, meant to be called every 5 ms by
+ * timer1. Fires the press and release callbacks on debounced edges.
+ */
 void button_checkState(void*);
 /**
  * Initializes rotary encoder and joystick button
  */
 void button_init(bool debounce);
 
+/**
+ * Initializes rotary encoder and joystick button with adaptive debouncing:
+ * a pin change interrupt wakes the debouncer on the first edge, timer1 then
+ * samples every 5 ms until all buttons are released and stable for 500 ms
+ * (see button_setAdaptiveIdleTime) and is stopped again. While nobody
+ * touches the board no interrupt occurs.
+ */
+void button_initAdaptive(void);
+
+/**
+ * Sets how long the buttons must be released and stable before adaptive
+ * debouncing stops timer1. Timeouts counted on the debounce tick, like the
+ * gesture double click time, must be shorter; gesture_setConfig calls this.
+ * Values below 500 ms are raised to 500 ms.
+ */
+void button_setAdaptiveIdleTime(uint16_t ms);
+
+/**
+ * Number of debounce ticks (timer1 interrupts) since start.
+ */
+uint32_t button_getDebounceTickCount(void);
+
+/**
+ * Number of pin change wakeups in adaptive mode since start. Together with
+ * button_getDebounceTickCount this gives the button interrupt load, e.g.
+ * per hour while idle (720000 timer1 ticks with button_init(true)).
+ */
+uint32_t button_getWakeupCount(void);
+
 /** 
  * Get the state of the joystick button.
  */
@@ -26,8 +69,46 @@ bool button_isJoystickPressed(void);
 bool button_isRotaryPressed(void);
 
 typedef void (*pButtonCallback)(void*);
+
+/**type of function pointer called with the debounced state bitmap
+ */
+typedef void (*pButtonStateCallback)(uint8_t state);
 void button_setRotaryButtonCallback(pButtonCallback);
 void button_setJoystickButtonCallback(pButtonCallback);
+
+/**
+ * Sets a function to be called on the debounced press edge of a button.
+ *
+ * @param button  element of the ButtonIds enum
+ * @param cb      pointer to the callback function; if NULL, no callback
+ *                will be executed.
+ */
+void button_setPressCallback(uint8_t button, pButtonCallback cb);
+
+/**
+ * Sets a function to be called on the debounced release edge of a button.
+ *
+ * @param button  element of the ButtonIds enum
+ * @param cb      pointer to the callback function; if NULL, no callback
+ *                will be executed.
+ */
+void button_setReleaseCallback(uint8_t button, pButtonCallback cb);
+
+/**
+ * Sets a function to be called with the debounced state after every
+ * debounce tick, e.g. to layer a gesture recognizer on top.
+ *
+ * @param cb  pointer to the callback function; if NULL, no callback
+ *            will be executed.
+ */
+void button_setStateCallback(pButtonStateCallback cb);
+
+/**
+ * Get the debounced state of all buttons.
+ *
+ * @return bit i is set while the button with ButtonIds i is pressed
+ */
+uint8_t button_getDebouncedState(void);
 //void button_checkState();
 
 #endif /* SES_BUTTON_H_ */
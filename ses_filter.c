@@ -0,0 +1,200 @@
+/*
+ ***************************************************************************
+ ses_filter V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_filter is a small fixed-point filter library for sample streams such as
+ the ADC channels (temperature, light) or the motor frequency. It offers a
+ moving average, a single-pole IIR, a sliding median and a decimator. All
+ filters are declared statically with the FILTER_xxx macros and can be used
+ alone or connected as a chain of stages.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_filter.h"
+#include <string.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+#define IIR_FRACTION_BITS          8
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+/*
+ * first position in the sorted window whose value is >= value
+ */
+static uint8_t median_lowerBound(const filter_sample_t* sorted, uint8_t n,
+		filter_sample_t value) {
+
+	uint8_t low = 0;
+	uint8_t high = n;
+
+	while (low < high) {
+		uint8_t mid = (low + high) >> 1;
+		if (sorted[mid] < value) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+filter_sample_t filter_movingAverageProcess(filter_movingAverage_t* f,
+		filter_sample_t sample) {
+
+	/*
+	 * the oldest sample leaves the running sum and the new one enters,
+	 * so the cost does not depend on the window size
+	 */
+	f->sum -= f->buffer[f->index];
+	f->sum += sample;
+	f->buffer[f->index] = sample;
+
+	/* the window has at most 256 samples, so the mask fits the index */
+	f->index = (f->index + 1) & ((1 << f->shift) - 1);
+
+	return (filter_sample_t) (f->sum >> f->shift);
+}
+
+filter_sample_t filter_iirProcess(filter_iir_t* f, filter_sample_t sample) {
+
+	int32_t input = (int32_t) sample << IIR_FRACTION_BITS;
+
+	if (!f->primed) {
+		f->state = input;
+		f->primed = true;
+	} else {
+		f->state += (input - f->state) >> f->shift;
+	}
+
+	/* round to the nearest integer */
+	return (filter_sample_t) ((f->state + (1 << (IIR_FRACTION_BITS - 1)))
+			>> IIR_FRACTION_BITS);
+}
+
+filter_sample_t filter_medianProcess(filter_median_t* f, filter_sample_t sample) {
+
+	uint8_t position;
+
+	if (f->count == f->size) {
+		/*
+		 * window is full: the oldest sample is removed from the sorted
+		 * array first, its slot in the ring is then reused
+		 */
+		position = median_lowerBound(f->sorted, f->count,
+				f->samples[f->index]);
+		memmove(&f->sorted[position], &f->sorted[position + 1],
+				(f->count - position - 1) * sizeof(filter_sample_t));
+		f->count--;
+	}
+
+	f->samples[f->index] = sample;
+	f->index++;
+	if (f->index == f->size) {
+		f->index = 0;
+	}
+
+	position = median_lowerBound(f->sorted, f->count, sample);
+	memmove(&f->sorted[position + 1], &f->sorted[position],
+			(f->count - position) * sizeof(filter_sample_t));
+	f->sorted[position] = sample;
+	f->count++;
+
+	return f->sorted[f->count >> 1];
+}
+
+filter_sample_t filter_medianGet(const filter_median_t* f) {
+
+	if (f->count == 0) {
+		return 0;
+	}
+	return f->sorted[f->count >> 1];
+}
+
+bool filter_decimatorProcess(filter_decimator_t* f, filter_sample_t sample,
+		filter_sample_t* out) {
+
+	f->sum += sample;
+	f->count++;
+
+	if (f->count < (1 << f->shift)) {
+		return false;
+	}
+
+	*out = (filter_sample_t) (f->sum >> f->shift);
+	f->sum = 0;
+	f->count = 0;
+	return true;
+}
+
+void filter_reset(uint8_t type, void* filter) {
+
+	switch (type) {
+	case FILTER_TYPE_MOVING_AVERAGE: {
+		filter_movingAverage_t* f = filter;
+		memset(f->buffer, 0, (1 << f->shift) * sizeof(filter_sample_t));
+		f->index = 0;
+		f->sum = 0;
+		break;
+	}
+	case FILTER_TYPE_IIR: {
+		filter_iir_t* f = filter;
+		f->primed = false;
+		f->state = 0;
+		break;
+	}
+	case FILTER_TYPE_MEDIAN: {
+		filter_median_t* f = filter;
+		f->index = 0;
+		f->count = 0;
+		break;
+	}
+	case FILTER_TYPE_DECIMATOR: {
+		filter_decimator_t* f = filter;
+		f->count = 0;
+		f->sum = 0;
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+bool filter_chainProcess(const filter_stage_t* stages, uint8_t n,
+		filter_sample_t sample, filter_sample_t* out) {
+
+	for (uint8_t i = 0; i < n; i++) {
+
+		switch (stages[i].type) {
+		case FILTER_TYPE_MOVING_AVERAGE:
+			sample = filter_movingAverageProcess(stages[i].filter, sample);
+			break;
+		case FILTER_TYPE_IIR:
+			sample = filter_iirProcess(stages[i].filter, sample);
+			break;
+		case FILTER_TYPE_MEDIAN:
+			sample = filter_medianProcess(stages[i].filter, sample);
+			break;
+		case FILTER_TYPE_DECIMATOR:
+			/*
+			 * the following stages only see one sample per block
+			 */
+			if (!filter_decimatorProcess(stages[i].filter, sample, &sample)) {
+				return false;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	*out = sample;
+	return true;
+}
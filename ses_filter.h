@@ -0,0 +1,169 @@
+#ifndef SES_FILTER_H_
+#define SES_FILTER_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ses_common.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* largest moving average window is 2^8 samples, the ring index is 8 bit */
+#define FILTER_MAX_AVERAGE_LOG2  8
+
+/* largest decimation factor is 2^7, the sample count is 8 bit */
+#define FILTER_MAX_DECIMATOR_LOG2  7
+
+/**
+ * Static declaration helpers. Every filter owns its storage, so a filter is
+ * declared once at file scope and no heap is used.
+ *
+ * example: FILTER_MOVING_AVERAGE(lightAverage, 3); averages 8 samples
+ */
+#define FILTER_MOVING_AVERAGE(name, log2Size)                                 \
+	_Static_assert((log2Size) <= FILTER_MAX_AVERAGE_LOG2,                     \
+			"moving average window is limited to 2^8 samples");               \
+	static filter_sample_t name##_buffer[1 << (log2Size)];                    \
+	static filter_movingAverage_t name = { .buffer = name##_buffer,           \
+			.shift = (log2Size) }
+
+#define FILTER_IIR(name, k)                                                   \
+	static filter_iir_t name = { .shift = (k) }
+
+#define FILTER_MEDIAN(name, windowSize)                                       \
+	static filter_sample_t name##_samples[(windowSize)];                      \
+	static filter_sample_t name##_sorted[(windowSize)];                       \
+	static filter_median_t name = { .samples = name##_samples,                \
+			.sorted = name##_sorted, .size = (windowSize) }
+
+#define FILTER_DECIMATOR(name, log2Factor)                                    \
+	_Static_assert((log2Factor) <= FILTER_MAX_DECIMATOR_LOG2,                 \
+			"decimation factor is limited to 2^7 samples");                   \
+	static filter_decimator_t name = { .shift = (log2Factor) }
+
+/* TYPES ********************************************************************/
+
+/**type of one sample flowing through a filter (raw ADC value, frequency...)
+ */
+typedef uint16_t filter_sample_t;
+
+/**moving average over 2^shift samples, kept as a running sum
+ */
+typedef struct {
+	filter_sample_t* buffer; ///< ring of the last 2^shift samples
+	uint8_t shift;           ///< log2 of the window size, at most 8
+	uint8_t index;           ///< next position to overwrite
+	uint32_t sum;            ///< running sum of the buffer content
+} filter_movingAverage_t;
+
+/**single-pole IIR: y += (x - y) / 2^shift, state kept with 8 fraction bits
+ */
+typedef struct {
+	uint8_t shift;           ///< smoothing factor, larger is smoother
+	bool primed;             ///< false until the first sample was seen
+	int32_t state;           ///< filter output in Q8
+} filter_iir_t;
+
+/**sliding median, the window is kept sorted by binary insertion
+ */
+typedef struct {
+	filter_sample_t* samples; ///< window in arrival order (ring)
+	filter_sample_t* sorted;  ///< same window, sorted ascending
+	uint8_t size;             ///< window size, odd sizes give a true median
+	uint8_t index;            ///< oldest sample in samples
+	uint8_t count;            ///< number of valid samples
+} filter_median_t;
+
+/**decimator: outputs the mean of every block of 2^shift samples
+ */
+typedef struct {
+	uint8_t shift;           ///< log2 of the decimation factor, at most 7
+	uint8_t count;           ///< samples collected in the current block
+	uint32_t sum;            ///< sum of the current block
+} filter_decimator_t;
+
+enum FilterTypes {
+	FILTER_TYPE_MOVING_AVERAGE = 0,
+	FILTER_TYPE_IIR,
+	FILTER_TYPE_MEDIAN,
+	FILTER_TYPE_DECIMATOR
+};
+
+/**one stage of a filter chain
+ */
+typedef struct {
+	uint8_t type;            ///< element of the FilterTypes enum
+	void* filter;            ///< pointer to the filter of that type
+} filter_stage_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Adds a sample to the moving average.
+ *
+ * @param f       moving average filter
+ * @param sample  new sample
+ * @return        mean of the last 2^shift samples
+ */
+filter_sample_t filter_movingAverageProcess(filter_movingAverage_t* f,
+		filter_sample_t sample);
+
+/**
+ * Adds a sample to the IIR filter. The first sample initializes the state.
+ *
+ * @param f       IIR filter
+ * @param sample  new sample
+ * @return        filtered value
+ */
+filter_sample_t filter_iirProcess(filter_iir_t* f, filter_sample_t sample);
+
+/**
+ * Adds a sample to the sliding median, replacing the oldest one.
+ *
+ * @param f       median filter
+ * @param sample  new sample
+ * @return        median of the current window
+ */
+filter_sample_t filter_medianProcess(filter_median_t* f, filter_sample_t sample);
+
+/**
+ * Reads the median of the current window without adding a sample.
+ *
+ * @param f       median filter
+ * @return        median, 0 if no sample was added yet
+ */
+filter_sample_t filter_medianGet(const filter_median_t* f);
+
+/**
+ * Adds a sample to the decimator.
+ *
+ * @param f       decimator
+ * @param sample  new sample
+ * @param out     mean of the block, only written when a block completes
+ * @return        true, if a block completed and out was written
+ */
+bool filter_decimatorProcess(filter_decimator_t* f, filter_sample_t sample,
+		filter_sample_t* out);
+
+/**
+ * Resets any filter to its empty state.
+ *
+ * @param type    element of the FilterTypes enum
+ * @param filter  pointer to the filter
+ */
+void filter_reset(uint8_t type, void* filter);
+
+/**
+ * Runs a sample through a chain of filters, first stage first.
+ *
+ * @param stages  array of stages
+ * @param n       number of stages
+ * @param sample  input sample
+ * @param out     output of the last stage
+ * @return        false, if a decimator swallowed the sample (out unchanged)
+ */
+bool filter_chainProcess(const filter_stage_t* stages, uint8_t n,
+		filter_sample_t sample, filter_sample_t* out);
+
+#endif /* SES_FILTER_H_ */
@@ -0,0 +1,246 @@
+/*
+ ***************************************************************************
+ ses_font V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_font draws large characters, e.g. the alarm clock digits, into the
+ framebuffer. Glyphs are stored as columns of font->pages bytes (top page
+ first, bit 0 is the top pixel) and run length encoded by columns, as
+ vertical strokes and the gaps of seven segment digits repeat the same
+ column many times:
+
+   token 0x00..0x7F  (token + 1) literal columns follow
+   token 0x80..0xFF  the previous column again (token & 0x7F) + 1 times
+
+ The decoder writes every column with framebuffer_setColumn, which skips
+ unchanged bytes, so redrawing a digit that did not change is free.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_font.h"
+#include "ses_framebuffer.h"
+#include <string.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+#define TOKEN_REPEAT             0x80
+#define TOKEN_COUNT_MASK         0x7F
+
+/* FONT DATA *****************************************************************/
+
+/* fontDigits16: 16 pixels high, 137 bytes encoded, 200 bytes as plain bitmap */
+static const uint8_t fontDigits16_data[] PROGMEM = {
+		/* '-' */
+		0x00, 0x80, 0x01, 0x86,
+		/* '.' */
+		0x00, 0x00, 0xC0, 0x80,
+		/* '/' */
+		0x07, 0x00, 0xE0, 0x00, 0x78, 0x00, 0x1E, 0x80, 0x07, 0xE0, 0x01, 0x78,
+		0x00, 0x1E, 0x00, 0x07, 0x00,
+		/* '0' */
+		0x00, 0xFF, 0xFF, 0x80, 0x00, 0x03, 0xC0, 0x82, 0x00, 0xFF, 0xFF, 0x80,
+		/* '1' */
+		0x00, 0x00, 0x00, 0x84, 0x00, 0xFF, 0xFF, 0x80,
+		/* '2' */
+		0x00, 0x83, 0xFF, 0x80, 0x00, 0x83, 0xC1, 0x82, 0x00, 0xFF, 0xC1, 0x80,
+		/* '3' */
+		0x00, 0x83, 0xC1, 0x84, 0x00, 0xFF, 0xFF, 0x80,
+		/* '4' */
+		0x00, 0xFF, 0x01, 0x80, 0x00, 0x80, 0x01, 0x82, 0x00, 0xFF, 0xFF, 0x80,
+		/* '5' */
+		0x00, 0xFF, 0xC1, 0x80, 0x00, 0x83, 0xC1, 0x82, 0x00, 0x83, 0xFF, 0x80,
+		/* '6' */
+		0x00, 0xFF, 0xFF, 0x80, 0x00, 0x83, 0xC1, 0x82, 0x00, 0x83, 0xFF, 0x80,
+		/* '7' */
+		0x00, 0x03, 0x00, 0x84, 0x00, 0xFF, 0xFF, 0x80,
+		/* '8' */
+		0x00, 0xFF, 0xFF, 0x80, 0x00, 0x83, 0xC1, 0x82, 0x00, 0xFF, 0xFF, 0x80,
+		/* '9' */
+		0x00, 0xFF, 0xC1, 0x80, 0x00, 0x83, 0xC1, 0x82, 0x00, 0xFF, 0xFF, 0x80,
+		/* ':' */
+		0x00, 0x30, 0x0C, 0x80
+};
+
+static const uint16_t fontDigits16_offsets[] PROGMEM = {
+		0, 4, 8, 25, 37, 45, 57, 65, 77, 89, 101, 109, 121, 133 };
+
+static const uint8_t fontDigits16_widths[] PROGMEM = {
+		8, 2, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 2 };
+
+const font_t fontDigits16 PROGMEM = { .first = '-', .last = ':', .pages = 2,
+		.spacing = 1, .blankWidth = 8, .data = fontDigits16_data, .offsets =
+		fontDigits16_offsets, .widths = fontDigits16_widths };
+
+/* fontDigits32: 32 pixels high, 356 bytes encoded, 800 bytes as plain bitmap */
+static const uint8_t fontDigits32_data[] PROGMEM = {
+		/* '-' */
+		0x01, 0x00, 0x80, 0x01, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x8C, 0x00, 0x00,
+		0x80, 0x01, 0x00,
+		/* '.' */
+		0x00, 0x00, 0x00, 0x00, 0xF0, 0x82,
+		/* '/' */
+		0x0F, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xFE, 0x00, 0x00, 0x80,
+		0x7F, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0x00, 0xF8, 0x07, 0x00, 0x00, 0xFE,
+		0x01, 0x00, 0x80, 0x7F, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0x00, 0xF8, 0x07,
+		0x00, 0x00, 0xFE, 0x01, 0x00, 0x80, 0x7F, 0x00, 0x00, 0xE0, 0x1F, 0x00,
+		0x00, 0xF8, 0x07, 0x00, 0x00, 0xFE, 0x01, 0x00, 0x00, 0x7F, 0x00, 0x00,
+		0x00, 0x1F, 0x00, 0x00, 0x00,
+		/* '0' */
+		0x01, 0xFE, 0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x00, 0x0F,
+		0x00, 0x00, 0xF0, 0x86, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x00, 0xFE,
+		0xFF, 0xFF, 0x7F,
+		/* '1' */
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x8A, 0x01, 0xFE, 0xFF, 0xFF, 0x7F, 0xFF,
+		0xFF, 0xFF, 0xFF, 0x80, 0x00, 0xFE, 0xFF, 0xFF, 0x7F,
+		/* '2' */
+		0x01, 0x06, 0x80, 0xFF, 0x7F, 0x0F, 0xC0, 0xFF, 0xFF, 0x81, 0x00, 0x0F,
+		0xC0, 0x03, 0xF0, 0x86, 0x00, 0xFF, 0xFF, 0x03, 0xF0, 0x81, 0x00, 0xFE,
+		0xFF, 0x01, 0x60,
+		/* '3' */
+		0x01, 0x06, 0x80, 0x01, 0x60, 0x0F, 0xC0, 0x03, 0xF0, 0x89, 0x00, 0xFF,
+		0xFF, 0xFF, 0xFF, 0x81, 0x00, 0xFE, 0xFF, 0xFF, 0x7F,
+		/* '4' */
+		0x01, 0xFE, 0xFF, 0x01, 0x00, 0xFF, 0xFF, 0x03, 0x00, 0x80, 0x01, 0xFE,
+		0xFF, 0x03, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x86, 0x01, 0xFE, 0xFF, 0xFF,
+		0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x80, 0x00, 0xFE, 0xFF, 0xFF, 0x7F,
+		/* '5' */
+		0x01, 0xFE, 0xFF, 0x01, 0x60, 0xFF, 0xFF, 0x03, 0xF0, 0x81, 0x00, 0x0F,
+		0xC0, 0x03, 0xF0, 0x86, 0x00, 0x0F, 0xC0, 0xFF, 0xFF, 0x81, 0x00, 0x06,
+		0x80, 0xFF, 0x7F,
+		/* '6' */
+		0x01, 0xFE, 0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x00, 0x0F,
+		0xC0, 0x03, 0xF0, 0x86, 0x00, 0x0F, 0xC0, 0xFF, 0xFF, 0x81, 0x00, 0x06,
+		0x80, 0xFF, 0x7F,
+		/* '7' */
+		0x01, 0x06, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x89, 0x01, 0xFF,
+		0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x80, 0x00, 0xFE, 0xFF, 0xFF,
+		0x7F,
+		/* '8' */
+		0x01, 0xFE, 0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x00, 0x0F,
+		0xC0, 0x03, 0xF0, 0x86, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x00, 0xFE,
+		0xFF, 0xFF, 0x7F,
+		/* '9' */
+		0x01, 0xFE, 0xFF, 0x01, 0x60, 0xFF, 0xFF, 0x03, 0xF0, 0x81, 0x00, 0x0F,
+		0xC0, 0x03, 0xF0, 0x86, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x00, 0xFE,
+		0xFF, 0xFF, 0x7F,
+		/* ':' */
+		0x00, 0x00, 0x0F, 0xF0, 0x00, 0x82
+};
+
+static const uint16_t fontDigits32_offsets[] PROGMEM = {
+		0, 15, 21, 86, 113, 134, 161, 182, 217, 244, 271, 296, 323, 350 };
+
+static const uint8_t fontDigits32_widths[] PROGMEM = {
+		16, 4, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 4 };
+
+const font_t fontDigits32 PROGMEM = { .first = '-', .last = ':', .pages = 4,
+		.spacing = 2, .blankWidth = 16, .data = fontDigits32_data, .offsets =
+		fontDigits32_offsets, .widths = fontDigits32_widths };
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static void font_clearColumns(uint8_t pages, uint8_t x, uint8_t page,
+		uint8_t count) {
+
+	for (uint8_t i = 0; i < count; i++) {
+		for (uint8_t p = 0; p < pages; p++) {
+			framebuffer_setColumn(page + p, x + i, 0);
+		}
+	}
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+uint8_t font_drawChar(const font_t* font, uint8_t x, uint8_t page, char chr) {
+
+	font_t f;
+	memcpy_P(&f, font, sizeof(f));
+
+	if (chr < f.first || chr > f.last) {
+		font_clearColumns(f.pages, x, page, f.blankWidth + f.spacing);
+		return f.blankWidth + f.spacing;
+	}
+
+	uint8_t index = chr - f.first;
+	const uint8_t* data = f.data + pgm_read_word(&f.offsets[index]);
+	uint8_t width = pgm_read_byte(&f.widths[index]);
+	uint8_t column[FONT_MAX_PAGES];
+	uint8_t drawn = 0;
+
+	while (drawn < width) {
+		uint8_t token = pgm_read_byte(data++);
+		uint8_t count = (token & TOKEN_COUNT_MASK) + 1;
+
+		while (count != 0 && drawn < width) {
+			/* a repeat token keeps the last decoded column */
+			if (!(token & TOKEN_REPEAT)) {
+				for (uint8_t p = 0; p < f.pages; p++) {
+					column[p] = pgm_read_byte(data++);
+				}
+			}
+			for (uint8_t p = 0; p < f.pages; p++) {
+				framebuffer_setColumn(page + p, x + drawn, column[p]);
+			}
+			drawn++;
+			count--;
+		}
+	}
+
+	font_clearColumns(f.pages, x + width, page, f.spacing);
+	return width + f.spacing;
+}
+
+uint8_t font_drawString(const font_t* font, uint8_t x, uint8_t page,
+		const char* string) {
+
+	while (*string != '\0' && x < FRAMEBUFFER_WIDTH) {
+		x += font_drawChar(font, x, page, *string++);
+	}
+	return x;
+}
+
+uint16_t font_getStringWidth(const font_t* font, const char* string) {
+
+	font_t f;
+	uint16_t width = 0;
+
+	memcpy_P(&f, font, sizeof(f));
+
+	while (*string != '\0') {
+		char chr = *string++;
+
+		if (chr < f.first || chr > f.last) {
+			width += f.blankWidth;
+		} else {
+			width += pgm_read_byte(&f.widths[chr - f.first]);
+		}
+		width += f.spacing;
+	}
+	return width;
+}
+
+uint8_t font_drawTime(const font_t* font, uint8_t x, uint8_t page,
+		const struct time_t* time, bool withSeconds) {
+
+	char text[9];
+
+	text[0] = '0' + time->hour / 10;
+	text[1] = '0' + time->hour % 10;
+	text[2] = ':';
+	text[3] = '0' + time->minute / 10;
+	text[4] = '0' + time->minute % 10;
+	text[5] = '\0';
+
+	if (withSeconds) {
+		text[5] = ':';
+		text[6] = '0' + time->second / 10;
+		text[7] = '0' + time->second % 10;
+		text[8] = '\0';
+	}
+
+	return font_drawString(font, x, page, text);
+}
@@ -0,0 +1,81 @@
+#ifndef SES_FONT_H_
+#define SES_FONT_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include "ses_common.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* largest glyph height in pages a font may have */
+#define FONT_MAX_PAGES           4
+
+/* TYPES ********************************************************************/
+
+/**font with run length encoded glyphs, the descriptor and all tables are
+ * in flash
+ */
+typedef struct {
+	char first;               ///< first character of the font
+	char last;                ///< last character of the font
+	uint8_t pages;            ///< glyph height in pages (8 pixels each)
+	uint8_t spacing;          ///< empty columns after every glyph
+	uint8_t blankWidth;       ///< columns of characters not in the font
+	const uint8_t* data;      ///< encoded glyphs
+	const uint16_t* offsets;  ///< start of every glyph in data
+	const uint8_t* widths;    ///< columns of every glyph
+} font_t;
+
+/* EXTERNALS *****************************************************************/
+
+/**
+ * Seven segment style fonts for "-./0123456789:", other characters are
+ * drawn as blanks of digit width, so a blinking clock does not move.
+ * fontDigits16: 8x16 digits, 2 pages; fontDigits32: 16x32 digits, all 4
+ * pages, "23:59:59" fits the display width.
+ */
+extern const font_t fontDigits16;
+extern const font_t fontDigits32;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Draws a character into the framebuffer, the spacing columns after it
+ * are cleared. Columns outside the display are dropped.
+ *
+ * @param font  font in flash, e.g. &fontDigits32
+ * @param x     left column
+ * @param page  top page
+ * @param chr   character to draw
+ * @return      columns used including the spacing
+ */
+uint8_t font_drawChar(const font_t* font, uint8_t x, uint8_t page, char chr);
+
+/**
+ * Draws a string from RAM, see font_drawChar.
+ *
+ * @return column after the last character
+ */
+uint8_t font_drawString(const font_t* font, uint8_t x, uint8_t page,
+		const char* string);
+
+/**
+ * @return columns a string needs including the spacing
+ */
+uint16_t font_getStringWidth(const font_t* font, const char* string);
+
+/**
+ * Draws a time as "hh:mm" or "hh:mm:ss" for the alarm clock.
+ *
+ * @param time         time to draw
+ * @param withSeconds  true to add the seconds
+ * @return             column after the last character
+ */
+uint8_t font_drawTime(const font_t* font, uint8_t x, uint8_t page,
+		const struct time_t* time, bool withSeconds);
+
+#endif /* SES_FONT_H_ */
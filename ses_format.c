@@ -0,0 +1,238 @@
+/*
+ ***************************************************************************
+ ses_format V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_format is a small replacement for fprintf on the display and UART
+ paths. Every conversion has its own function, so no format string is
+ parsed and no varargs are used. Decimal digits are produced by
+ subtracting powers of ten from a flash table, which avoids the 32 bit
+ division of the library routines. Buffers can be opened as streams, so
+ the same functions write to lcdout, uartout or memory.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_format.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* uint32_t has up to 10 decimal digits */
+#define MAX_DIGITS               10
+
+#define MAX_DECIMALS             9
+#define MAX_FRACTION_BITS        24
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static const uint32_t powersOfTen[MAX_DIGITS] PROGMEM = { 1000000000UL,
+		100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL,
+		10UL, 1UL };
+
+static const char hexDigits[16] PROGMEM = "0123456789ABCDEF";
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static int format_bufferPut(char chr, FILE* stream) {
+
+	formatBuffer_t* buffer = fdev_get_udata(stream);
+
+	if (buffer->length + 1 < buffer->size) {
+		buffer->data[buffer->length++] = chr;
+		buffer->data[buffer->length] = '\0';
+	}
+	return 0;
+}
+
+/*
+ * decimal digits of value, most significant first, at least minDigits
+ * (leading zeros), returns the number of digits written to out
+ */
+static uint8_t format_digits(uint32_t value, char* out, uint8_t minDigits) {
+
+	uint8_t count = 0;
+
+	for (uint8_t i = 0; i < MAX_DIGITS; i++) {
+		uint32_t power = pgm_read_dword(&powersOfTen[i]);
+		char digit = '0';
+
+		while (value >= power) {
+			value -= power;
+			digit++;
+		}
+
+		if (count != 0 || digit != '0' || MAX_DIGITS - i <= minDigits) {
+			out[count++] = digit;
+		}
+	}
+	return count;
+}
+
+static void format_pad(FILE* stream, char pad, uint8_t width, uint8_t used) {
+
+	while (used < width) {
+		fputc(pad, stream);
+		used++;
+	}
+}
+
+/*
+ * writes sign, integer digits and an optional fraction, padded to width
+ */
+static void format_putField(FILE* stream, bool negative, const char* digits,
+		uint8_t count, const char* fraction, uint8_t decimals, uint8_t width,
+		char pad) {
+
+	uint8_t used = count + (negative ? 1 : 0)
+			+ (decimals != 0 ? decimals + 1 : 0);
+
+	if (pad == '0') {
+		if (negative) {
+			fputc('-', stream);
+		}
+		format_pad(stream, pad, width, used);
+	} else {
+		format_pad(stream, pad, width, used);
+		if (negative) {
+			fputc('-', stream);
+		}
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		fputc(digits[i], stream);
+	}
+
+	if (decimals != 0) {
+		fputc('.', stream);
+		for (uint8_t i = 0; i < decimals; i++) {
+			fputc(fraction[i], stream);
+		}
+	}
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+FILE* format_openBuffer(formatBuffer_t* buffer, char* data, uint8_t size) {
+
+	buffer->data = data;
+	buffer->size = size;
+	buffer->length = 0;
+	if (size != 0) {
+		data[0] = '\0';
+	}
+
+	fdev_setup_stream(&buffer->stream, format_bufferPut, NULL,
+			_FDEV_SETUP_WRITE);
+	fdev_set_udata(&buffer->stream, buffer);
+	return &buffer->stream;
+}
+
+void format_putString(FILE* stream, const char* string) {
+
+	while (*string != '\0') {
+		fputc(*string++, stream);
+	}
+}
+
+void format_putString_P(FILE* stream, PGM_P string) {
+
+	char chr;
+
+	while ((chr = pgm_read_byte(string++)) != '\0') {
+		fputc(chr, stream);
+	}
+}
+
+void format_putUnsigned(FILE* stream, uint32_t value, uint8_t width, char pad) {
+
+	char digits[MAX_DIGITS];
+	uint8_t count = format_digits(value, digits, 1);
+
+	format_putField(stream, false, digits, count, NULL, 0, width, pad);
+}
+
+void format_putSigned(FILE* stream, int32_t value, uint8_t width, char pad) {
+
+	char digits[MAX_DIGITS];
+	bool negative = (value < 0);
+	uint32_t magnitude = negative ? -(uint32_t) value : (uint32_t) value;
+	uint8_t count = format_digits(magnitude, digits, 1);
+
+	format_putField(stream, negative, digits, count, NULL, 0, width, pad);
+}
+
+void format_putDecimal(FILE* stream, int32_t value, uint8_t decimals,
+		uint8_t width, char pad) {
+
+	char digits[MAX_DIGITS];
+	bool negative = (value < 0);
+	uint32_t magnitude = negative ? -(uint32_t) value : (uint32_t) value;
+	uint8_t count;
+
+	if (decimals > MAX_DECIMALS) {
+		decimals = MAX_DECIMALS;
+	}
+
+	/*
+	 * one digit before the point at least, the last digits are the
+	 * fraction
+	 */
+	count = format_digits(magnitude, digits, decimals + 1);
+
+	format_putField(stream, negative, digits, count - decimals,
+			&digits[count - decimals], decimals, width, pad);
+}
+
+void format_putFixed(FILE* stream, int32_t value, uint8_t fractionBits,
+		uint8_t decimals, uint8_t width, char pad) {
+
+	char digits[MAX_DIGITS];
+	char fraction[MAX_DECIMALS];
+	bool negative = (value < 0);
+	uint32_t magnitude = negative ? -(uint32_t) value : (uint32_t) value;
+	uint32_t mask;
+	uint32_t rest;
+	uint8_t count;
+
+	if (fractionBits > MAX_FRACTION_BITS) {
+		fractionBits = MAX_FRACTION_BITS;
+	}
+	if (decimals > MAX_DECIMALS) {
+		decimals = MAX_DECIMALS;
+	}
+
+	mask = (1UL << fractionBits) - 1;
+	count = format_digits(magnitude >> fractionBits, digits, 1);
+
+	/*
+	 * every decimal is the integer part of the remaining fraction times
+	 * ten; x * 10 = (x << 3) + (x << 1) needs no multiplication
+	 */
+	rest = magnitude & mask;
+	for (uint8_t i = 0; i < decimals; i++) {
+		rest = (rest << 3) + (rest << 1);
+		fraction[i] = '0' + (char) (rest >> fractionBits);
+		rest &= mask;
+	}
+
+	format_putField(stream, negative && (magnitude != 0), digits, count,
+			fraction, decimals, width, pad);
+}
+
+void format_putHex(FILE* stream, uint32_t value, uint8_t digits) {
+
+	if (digits == 0) {
+		digits = 1;
+	} else if (digits > 8) {
+		digits = 8;
+	}
+
+	while (digits != 0) {
+		digits--;
+		fputc(pgm_read_byte(&hexDigits[(value >> (digits << 2)) & 0x0F]),
+				stream);
+	}
+}
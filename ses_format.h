@@ -0,0 +1,91 @@
+#ifndef SES_FORMAT_H_
+#define SES_FORMAT_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <avr/pgmspace.h>
+#include "ses_common.h"
+
+/* TYPES ********************************************************************/
+
+/**character buffer usable as an output stream, see format_openBuffer
+ */
+typedef struct {
+	FILE stream;            ///< stream writing into data
+	char* data;             ///< buffer, always zero terminated
+	uint8_t size;           ///< size of data including the terminator
+	uint8_t length;         ///< characters written so far
+} formatBuffer_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Sets up a buffer as output stream. Characters that do not fit are
+ * dropped, the buffer stays zero terminated.
+ *
+ * @param buffer  buffer descriptor
+ * @param data    memory for the characters
+ * @param size    size of data, at least 1
+ * @return        stream for the format_xxx functions or fputc
+ */
+FILE* format_openBuffer(formatBuffer_t* buffer, char* data, uint8_t size);
+
+/**
+ * Writes a string from RAM.
+ */
+void format_putString(FILE* stream, const char* string);
+
+/**
+ * Writes a string from flash, e.g. format_putString_P(lcdout, PSTR("Temp"))
+ */
+void format_putString_P(FILE* stream, PGM_P string);
+
+/**
+ * Writes an unsigned decimal number.
+ *
+ * @param stream  output stream
+ * @param value   number to write
+ * @param width   minimum field width, 0 for none
+ * @param pad     fill character for the width, ' ' or '0'
+ */
+void format_putUnsigned(FILE* stream, uint32_t value, uint8_t width, char pad);
+
+/**
+ * Writes a signed decimal number. With '0' as pad the sign is written
+ * before the zeros.
+ */
+void format_putSigned(FILE* stream, int32_t value, uint8_t width, char pad);
+
+/**
+ * Writes a decimal fixed-point number, value is scaled by 10^decimals.
+ *
+ * example: format_putDecimal(stream, -2534, 2, 0, ' ') writes "-25.34"
+ *
+ * @param decimals  digits after the point, 0 to 9
+ */
+void format_putDecimal(FILE* stream, int32_t value, uint8_t decimals,
+		uint8_t width, char pad);
+
+/**
+ * Writes a binary fixed-point number (Qn) with a number of decimals,
+ * the last decimal is truncated.
+ *
+ * example: format_putFixed(stream, 0x0180, 8, 2, 0, ' ') writes "1.50"
+ *
+ * @param fractionBits  fraction bits of value, 0 to 24
+ * @param decimals      digits after the point, 0 to 9
+ */
+void format_putFixed(FILE* stream, int32_t value, uint8_t fractionBits,
+		uint8_t decimals, uint8_t width, char pad);
+
+/**
+ * Writes a hexadecimal number with upper case digits and leading zeros.
+ *
+ * @param digits  number of digits, 1 to 8
+ */
+void format_putHex(FILE* stream, uint32_t value, uint8_t digits);
+
+#endif /* SES_FORMAT_H_ */
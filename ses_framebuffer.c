@@ -0,0 +1,431 @@
+/*
+ ***************************************************************************
+ ses_framebuffer V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_framebuffer keeps the display content in RAM. Drawing only changes the
+ RAM copy and widens the dirty column range of the page; a flush compares
+ the dirty ranges with a copy of what the display shows and writes the
+ changed byte columns straight through the bus level of liblcd. A run of
+ changed columns is addressed once, the controller advances the column
+ by itself. Redrawing a screen that hardly changed therefore costs a few
+ bus writes instead of a full lcd_clear.
+
+ Tasks draw into the back buffer and present it when the frame is complete.
+ Presenting copies the dirty ranges into the front buffer, which a periodic
+ flush task sends a limited number of bytes at a time. While a flush is
+ running the front buffer is not touched, a frame presented meanwhile is
+ copied when the flush is done, so the display never shows half a frame.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_framebuffer.h"
+#include "ses_lcd.h"
+#include "ses_lcdDriver.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define NOT_DIRTY                0xFF
+
+/* byte columns the flush step may compare before it yields */
+#define FLUSH_SCAN_LIMIT         64
+
+/* EXTERNALS *****************************************************************/
+
+/* 6x8 font of liblcd, 6 column bytes per character */
+extern const uint8_t font6x8[];
+
+/* PRIVATE VARIABLES *********************************************************/
+
+/* back buffer for drawing, front buffer being flushed, display copy */
+static uint8_t frame[FRAMEBUFFER_PAGES][FRAMEBUFFER_WIDTH];
+static uint8_t front[FRAMEBUFFER_PAGES][FRAMEBUFFER_WIDTH];
+static uint8_t shown[FRAMEBUFFER_PAGES][FRAMEBUFFER_WIDTH];
+
+/* dirty column range of every page, dirtyFirst == NOT_DIRTY if clean */
+static uint8_t dirtyFirst[FRAMEBUFFER_PAGES] = { [0 ... FRAMEBUFFER_PAGES - 1
+		] = NOT_DIRTY };
+static uint8_t dirtyLast[FRAMEBUFFER_PAGES];
+
+/* column range of the front buffer the flush still has to compare */
+static uint8_t flushFirst[FRAMEBUFFER_PAGES] = { [0 ... FRAMEBUFFER_PAGES - 1
+		] = NOT_DIRTY };
+static uint8_t flushLast[FRAMEBUFFER_PAGES];
+
+static uint8_t flushPage = 0;
+static uint8_t flushX = 0;
+static bool flushing = false;
+static bool presentPending = false;
+
+static void framebuffer_flushTask(void* param);
+
+static taskDescriptor flushTask = { .task = &framebuffer_flushTask, .param =
+NULL, .expire = FRAMEBUFFER_FLUSH_PERIOD_MS, .period =
+FRAMEBUFFER_FLUSH_PERIOD_MS };
+
+static uint8_t cursorPos = 0;
+static uint8_t cursorRow = 0;
+
+static int framebuffer_put(char chr, FILE* stream);
+
+static FILE framebufferStream = FDEV_SETUP_STREAM(framebuffer_put, NULL,
+		_FDEV_SETUP_WRITE);
+
+FILE* framebufferOut = &framebufferStream;
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static inline void framebuffer_markDirty(uint8_t page, uint8_t x) {
+
+	if (dirtyFirst[page] == NOT_DIRTY) {
+		dirtyFirst[page] = x;
+		dirtyLast[page] = x;
+	} else if (x < dirtyFirst[page]) {
+		dirtyFirst[page] = x;
+	} else if (x > dirtyLast[page]) {
+		dirtyLast[page] = x;
+	}
+}
+
+static int framebuffer_put(char chr, FILE* stream) {
+
+	framebuffer_putc(chr);
+	return 0;
+}
+
+/*
+ * copies the dirty ranges of the back buffer into the front buffer and
+ * starts a flush of them, only called while no flush is running
+ */
+static void framebuffer_swap(void) {
+
+	for (uint8_t page = 0; page < FRAMEBUFFER_PAGES; page++) {
+
+		if (dirtyFirst[page] == NOT_DIRTY) {
+			continue;
+		}
+
+		for (uint8_t x = dirtyFirst[page]; x <= dirtyLast[page]; x++) {
+			front[page][x] = frame[page][x];
+		}
+
+		if (flushFirst[page] == NOT_DIRTY) {
+			flushFirst[page] = dirtyFirst[page];
+			flushLast[page] = dirtyLast[page];
+		} else {
+			if (dirtyFirst[page] < flushFirst[page]) {
+				flushFirst[page] = dirtyFirst[page];
+			}
+			if (dirtyLast[page] > flushLast[page]) {
+				flushLast[page] = dirtyLast[page];
+			}
+		}
+		dirtyFirst[page] = NOT_DIRTY;
+		flushing = true;
+	}
+
+	flushPage = 0;
+	flushX = 0;
+}
+
+static void framebuffer_flushTask(void* param) {
+	framebuffer_flushStep(FRAMEBUFFER_FLUSH_BYTES);
+}
+
+static inline void framebuffer_waitBusy(void) {
+	while (lcdDriver_readStatus() & LCD_STATUS_BUSY) {
+	}
+}
+
+/*
+ * points the controller of column x at the column and the page, in the
+ * same order as liblcd does it
+ */
+static void framebuffer_address(uint8_t page, uint8_t x) {
+
+	uint8_t controller = (x >= LCD_CONTROLLER_COLUMNS) ? 1 : 0;
+
+	lcdDriver_selectController(controller);
+	framebuffer_waitBusy();
+	lcdDriver_writeCommand(x - controller * LCD_CONTROLLER_COLUMNS);
+	framebuffer_waitBusy();
+	lcdDriver_writeCommand(LCD_COMMAND_PAGE | page);
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+void framebuffer_init(void) {
+
+	lcd_clear();
+
+	for (uint8_t page = 0; page < FRAMEBUFFER_PAGES; page++) {
+		for (uint8_t x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+			frame[page][x] = 0;
+			front[page][x] = 0;
+			shown[page][x] = 0;
+		}
+		dirtyFirst[page] = NOT_DIRTY;
+		flushFirst[page] = NOT_DIRTY;
+	}
+
+	cursorPos = 0;
+	cursorRow = 0;
+	flushing = false;
+	presentPending = false;
+
+	scheduler_add(&flushTask);
+}
+
+void framebuffer_clear(void) {
+
+	for (uint8_t page = 0; page < FRAMEBUFFER_PAGES; page++) {
+		for (uint8_t x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+			frame[page][x] = 0;
+		}
+		dirtyFirst[page] = 0;
+		dirtyLast[page] = FRAMEBUFFER_WIDTH - 1;
+	}
+
+	cursorPos = 0;
+	cursorRow = 0;
+}
+
+void framebuffer_setPixel(uint8_t x, uint8_t y, bool on) {
+
+	if (x >= FRAMEBUFFER_WIDTH || y >= FRAMEBUFFER_HEIGHT) {
+		return;
+	}
+
+	uint8_t page = y >> 3;
+	uint8_t mask = 1 << (y & 0x07);
+
+	if (on) {
+		frame[page][x] |= mask;
+	} else {
+		frame[page][x] &= ~mask;
+	}
+	framebuffer_markDirty(page, x);
+}
+
+bool framebuffer_getPixel(uint8_t x, uint8_t y) {
+
+	if (x >= FRAMEBUFFER_WIDTH || y >= FRAMEBUFFER_HEIGHT) {
+		return false;
+	}
+	return (frame[y >> 3][x] & (1 << (y & 0x07))) != 0;
+}
+
+void framebuffer_setColumn(uint8_t page, uint8_t x, uint8_t bits) {
+
+	if (page >= FRAMEBUFFER_PAGES || x >= FRAMEBUFFER_WIDTH) {
+		return;
+	}
+
+	/* rewriting the same byte does not make the page dirty */
+	if (frame[page][x] != bits) {
+		frame[page][x] = bits;
+		framebuffer_markDirty(page, x);
+	}
+}
+
+uint8_t framebuffer_getColumn(uint8_t page, uint8_t x) {
+
+	if (page >= FRAMEBUFFER_PAGES || x >= FRAMEBUFFER_WIDTH) {
+		return 0;
+	}
+	return frame[page][x];
+}
+
+void framebuffer_scrollLeft(uint8_t x, uint8_t width, uint8_t page,
+		uint8_t pages, uint8_t count) {
+
+	if (x >= FRAMEBUFFER_WIDTH || page >= FRAMEBUFFER_PAGES) {
+		return;
+	}
+	if (width > FRAMEBUFFER_WIDTH - x) {
+		width = FRAMEBUFFER_WIDTH - x;
+	}
+	if (pages > FRAMEBUFFER_PAGES - page) {
+		pages = FRAMEBUFFER_PAGES - page;
+	}
+	if (count > width) {
+		count = width;
+	}
+
+	for (uint8_t p = page; p < page + pages; p++) {
+
+		uint8_t* column = &frame[p][x];
+		uint8_t first = NOT_DIRTY;
+		uint8_t last = 0;
+
+		/*
+		 * the dirty range is narrowed to the columns that really
+		 * change, a scrolled flat line does not cost a flush
+		 */
+		for (uint8_t i = 0; i < width; i++) {
+			uint8_t bits = (i + count < width) ? column[i + count] : 0;
+
+			if (column[i] != bits) {
+				column[i] = bits;
+				if (first == NOT_DIRTY) {
+					first = i;
+				}
+				last = i;
+			}
+		}
+
+		if (first != NOT_DIRTY) {
+			framebuffer_markDirty(p, x + first);
+			framebuffer_markDirty(p, x + last);
+		}
+	}
+}
+
+void framebuffer_setCursor(uint8_t p, uint8_t r) {
+
+	cursorPos = p;
+	cursorRow = r;
+}
+
+void framebuffer_putc(char chr) {
+
+	if (chr == '\n') {
+		cursorPos = 0;
+		cursorRow++;
+		return;
+	}
+
+	if (cursorPos >= FRAMEBUFFER_TEXT_COLUMNS) {
+		cursorPos = 0;
+		cursorRow++;
+	}
+
+	if (cursorRow >= FRAMEBUFFER_PAGES) {
+		return;
+	}
+
+	const uint8_t* glyph = &font6x8[(uint8_t) chr * FRAMEBUFFER_CHAR_WIDTH];
+	uint8_t x = cursorPos * FRAMEBUFFER_CHAR_WIDTH;
+
+	for (uint8_t i = 0; i < FRAMEBUFFER_CHAR_WIDTH; i++) {
+		framebuffer_setColumn(cursorRow, x + i, glyph[i]);
+	}
+	cursorPos++;
+}
+
+bool framebuffer_isDirty(void) {
+
+	if (flushing || presentPending) {
+		return true;
+	}
+
+	for (uint8_t page = 0; page < FRAMEBUFFER_PAGES; page++) {
+		if (dirtyFirst[page] != NOT_DIRTY) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void framebuffer_present(void) {
+
+	if (flushing) {
+		presentPending = true;
+	} else {
+		framebuffer_swap();
+	}
+}
+
+bool framebuffer_isFlushing(void) {
+	return flushing || presentPending;
+}
+
+uint16_t framebuffer_flushStep(uint16_t maxBytes) {
+
+	uint16_t bytes = 0;
+	uint8_t scanned = 0;
+
+	/*
+	 * column the display writes to next, NOT_DIRTY if unknown. It is not
+	 * kept between steps, another task may have used the display.
+	 */
+	uint8_t address = NOT_DIRTY;
+
+	while (flushPage < FRAMEBUFFER_PAGES) {
+
+		uint8_t page = flushPage;
+
+		if (flushFirst[page] == NOT_DIRTY) {
+			flushPage++;
+			flushX = 0;
+			continue;
+		}
+		if (flushX < flushFirst[page]) {
+			flushX = flushFirst[page];
+		}
+
+		while (flushX <= flushLast[page]) {
+
+			uint8_t x = flushX;
+
+			if (front[page][x] == shown[page][x]) {
+				flushX++;
+				if (++scanned >= FLUSH_SCAN_LIMIT) {
+					return bytes;
+				}
+				continue;
+			}
+
+			if (bytes >= maxBytes) {
+				return bytes;
+			}
+
+			/*
+			 * only the first byte of a run and the first byte of the
+			 * second controller need the address commands
+			 */
+			if (x != address || x == LCD_CONTROLLER_COLUMNS) {
+				framebuffer_address(page, x);
+			}
+			framebuffer_waitBusy();
+			lcdDriver_writeData(front[page][x]);
+			shown[page][x] = front[page][x];
+			address = x + 1;
+			flushX++;
+			bytes++;
+		}
+
+		flushFirst[page] = NOT_DIRTY;
+		flushPage++;
+		flushX = 0;
+		address = NOT_DIRTY;
+	}
+
+	/*
+	 * the front buffer is on the display, a frame presented meanwhile
+	 * can be taken now
+	 */
+	flushing = false;
+	if (presentPending) {
+		presentPending = false;
+		framebuffer_swap();
+	}
+
+	return bytes;
+}
+
+uint16_t framebuffer_flush(void) {
+
+	uint16_t bytes = 0;
+
+	framebuffer_present();
+	while (framebuffer_isFlushing()) {
+		bytes += framebuffer_flushStep(0xFFFF);
+	}
+	return bytes;
+}
@@ -0,0 +1,148 @@
+#ifndef SES_FRAMEBUFFER_H_
+#define SES_FRAMEBUFFER_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "ses_common.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* display geometry, a page is a row of 8 pixel high columns (one byte) */
+#define FRAMEBUFFER_WIDTH        122
+#define FRAMEBUFFER_HEIGHT       32
+#define FRAMEBUFFER_PAGES        (FRAMEBUFFER_HEIGHT / 8)
+
+/* text cursor geometry, same as lcd_setCursor and lcd_putc */
+#define FRAMEBUFFER_CHAR_WIDTH   6
+#define FRAMEBUFFER_TEXT_COLUMNS 20
+
+/* flush task: period and byte columns sent per run */
+#ifndef FRAMEBUFFER_FLUSH_PERIOD_MS
+#define FRAMEBUFFER_FLUSH_PERIOD_MS  5
+#endif
+#ifndef FRAMEBUFFER_FLUSH_BYTES
+#define FRAMEBUFFER_FLUSH_BYTES      16
+#endif
+
+/* EXTERNALS *****************************************************************/
+
+/**
+ * Stream into the framebuffer, the counterpart of lcdout.
+ * Example fprintf(framebufferOut, "Temp=%d C", temperature);
+ */
+extern FILE* framebufferOut;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Clears the framebuffer together with the display and adds the flush task
+ * to the scheduler. lcd_init has to be called before. Afterwards the
+ * display must only be drawn through the framebuffer, the flush writes
+ * the display directly and liblcd's own copy of it gets stale.
+ */
+void framebuffer_init(void);
+
+/**
+ * Clears the back buffer, the display keeps its content until the next
+ * present.
+ */
+void framebuffer_clear(void);
+
+/**
+ * Sets or clears one pixel, pixels outside the display are ignored.
+ *
+ * @param x   horizontal position, 0 to FRAMEBUFFER_WIDTH - 1
+ * @param y   vertical position, 0 to FRAMEBUFFER_HEIGHT - 1
+ * @param on  set if true, clear otherwise
+ */
+void framebuffer_setPixel(uint8_t x, uint8_t y, bool on);
+
+/**
+ * @return true, if the pixel is set in the framebuffer
+ */
+bool framebuffer_getPixel(uint8_t x, uint8_t y);
+
+/**
+ * Writes one byte column of a page, bit 0 is the top pixel.
+ *
+ * @param page  0 to FRAMEBUFFER_PAGES - 1
+ * @param x     horizontal position
+ * @param bits  pixels of the column
+ */
+void framebuffer_setColumn(uint8_t page, uint8_t x, uint8_t bits);
+
+/**
+ * @return byte column of a page from the framebuffer
+ */
+uint8_t framebuffer_getColumn(uint8_t page, uint8_t x);
+
+/**
+ * Moves the columns of a page aligned area left, the columns moved in at
+ * the right edge are cleared. Only columns whose content changes become
+ * dirty.
+ *
+ * @param x      left column of the area
+ * @param width  number of columns of the area
+ * @param page   top page of the area
+ * @param pages  number of pages of the area
+ * @param count  number of columns to move by
+ */
+void framebuffer_scrollLeft(uint8_t x, uint8_t width, uint8_t page,
+		uint8_t pages, uint8_t count);
+
+/**
+ * Moves the text cursor, like lcd_setCursor.
+ *
+ * @param p  character position, 0 to FRAMEBUFFER_TEXT_COLUMNS - 1
+ * @param r  row (page) of the cursor
+ */
+void framebuffer_setCursor(uint8_t p, uint8_t r);
+
+/**
+ * Draws a character at the cursor and advances it, like lcd_putc.
+ * '\n' moves to the start of the next row.
+ *
+ * @param chr  character to draw
+ */
+void framebuffer_putc(char chr);
+
+/**
+ * @return true, if the display does not show the back buffer yet
+ */
+bool framebuffer_isDirty(void);
+
+/**
+ * Hands the back buffer to the flush task. Call it when a frame is
+ * complete; if a flush is running, the frame is taken when it is done,
+ * so the display never shows half of a frame. Drawing may go on at once.
+ */
+void framebuffer_present(void);
+
+/**
+ * @return true, while a presented frame is not completely on the display
+ */
+bool framebuffer_isFlushing(void);
+
+/**
+ * Sends up to maxBytes changed byte columns of the presented frame and
+ * compares at most 64 byte columns, then returns. Called by the flush task
+ * every FRAMEBUFFER_FLUSH_PERIOD_MS with FRAMEBUFFER_FLUSH_BYTES.
+ *
+ * @param maxBytes  byte budget of this step
+ * @return          number of bytes sent
+ */
+uint16_t framebuffer_flushStep(uint16_t maxBytes);
+
+/**
+ * Presents the back buffer and sends it completely, blocking. Only changed
+ * byte columns are sent, a run of them needs one column and one page
+ * command.
+ *
+ * @return number of bytes sent
+ */
+uint16_t framebuffer_flush(void);
+
+#endif /* SES_FRAMEBUFFER_H_ */
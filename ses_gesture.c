@@ -0,0 +1,214 @@
+/*
+ ***************************************************************************
+ ses_gesture V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_gesture is a library that recognizes button gestures (press, release,
+ click, double click, long press and auto-repeat) on top of the debounced
+ button state. It runs on every debounce tick of ses_button, does the same
+ small amount of work for each button on every tick, and puts timestamped
+ events into a queue that is read by the tasks.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_gesture.h"
+#include "ses_button.h"
+#include "util/atomic.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* button_checkState is called by timer1 every 5 ms */
+#define GESTURE_TICK_MS                 5
+
+#define GESTURE_QUEUE_MASK              (GESTURE_QUEUE_SIZE - 1)
+
+/* TYPES *********************************************************************/
+
+enum GestureStates {
+	STATE_IDLE = 0,         ///< released, nothing pending
+	STATE_HELD,             ///< first press, waiting for release or long press
+	STATE_WAIT_SECOND,      ///< released after a click, waiting for a second press
+	STATE_HELD_SECOND,      ///< second press within the double click time
+	STATE_HELD_LONG         ///< long press reported, auto-repeating
+};
+
+typedef struct {
+	uint8_t state;          ///< element of the GestureStates enum
+	uint16_t ticks;         ///< debounce ticks since the last state change
+} gestureButton_t;
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static gestureButton_t buttons[BUTTON_NUM];
+static uint8_t lastState = 0;
+
+static uint16_t longPressTicks;
+static uint16_t doubleClickTicks;
+static uint16_t repeatTicks;
+
+static gestureEvent_t queue[GESTURE_QUEUE_SIZE];
+static volatile uint8_t queueHead = 0; /* next slot to write, ISR only */
+static volatile uint8_t queueTail = 0; /* next slot to read, tasks only */
+static volatile uint8_t overflowCount = 0;
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static void gesture_push(uint8_t button, uint8_t type) {
+
+	uint8_t next = (queueHead + 1) & GESTURE_QUEUE_MASK;
+
+	/*
+	 * the oldest events are kept, a full queue drops the new one
+	 */
+	if (next == queueTail) {
+		if (overflowCount != 0xFF) {
+			overflowCount++;
+		}
+		return;
+	}
+
+	queue[queueHead].button = button;
+	queue[queueHead].type = type;
+	queue[queueHead].time = scheduler_getTime();
+	queueHead = next;
+}
+
+static void gesture_update(uint8_t state) {
+
+	uint8_t pressedEdges = state & ~lastState;
+	uint8_t releasedEdges = ~state & lastState;
+
+	lastState = state;
+
+	for (uint8_t i = 0; i < BUTTON_NUM; i++) {
+
+		gestureButton_t* b = &buttons[i];
+		uint8_t mask = (1 << i);
+
+		b->ticks++;
+
+		if (pressedEdges & mask) {
+
+			gesture_push(i, GESTURE_PRESS);
+			b->state = (b->state == STATE_WAIT_SECOND) ?
+					STATE_HELD_SECOND : STATE_HELD;
+			b->ticks = 0;
+
+		} else if (releasedEdges & mask) {
+
+			gesture_push(i, GESTURE_RELEASE);
+
+			if (b->state == STATE_HELD) {
+				if (doubleClickTicks == 0) {
+					gesture_push(i, GESTURE_CLICK);
+					b->state = STATE_IDLE;
+				} else {
+					b->state = STATE_WAIT_SECOND;
+				}
+			} else if (b->state == STATE_HELD_SECOND) {
+				gesture_push(i, GESTURE_DOUBLE_CLICK);
+				b->state = STATE_IDLE;
+			} else {
+				b->state = STATE_IDLE;
+			}
+			b->ticks = 0;
+
+		} else if (state & mask) {
+
+			if ((b->state == STATE_HELD || b->state == STATE_HELD_SECOND)
+					&& b->ticks >= longPressTicks) {
+				/*
+				 * a click followed by a long press reports the click first
+				 */
+				if (b->state == STATE_HELD_SECOND) {
+					gesture_push(i, GESTURE_CLICK);
+				}
+				gesture_push(i, GESTURE_LONG_PRESS);
+				b->state = STATE_HELD_LONG;
+				b->ticks = 0;
+			} else if (b->state == STATE_HELD_LONG && repeatTicks != 0
+					&& b->ticks >= repeatTicks) {
+				gesture_push(i, GESTURE_REPEAT);
+				b->ticks = 0;
+			}
+
+		} else if (b->state == STATE_WAIT_SECOND
+				&& b->ticks >= doubleClickTicks) {
+
+			gesture_push(i, GESTURE_CLICK);
+			b->state = STATE_IDLE;
+		}
+	}
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+void gesture_init(const gestureConfig_t* config) {
+
+	gestureConfig_t defaultConfig = {
+		.longPressMs = GESTURE_DEFAULT_LONG_PRESS_MS,
+		.doubleClickMs = GESTURE_DEFAULT_DOUBLE_CLICK_MS,
+		.repeatMs = GESTURE_DEFAULT_REPEAT_MS
+	};
+
+	if (config == NULL) {
+		config = &defaultConfig;
+	}
+	gesture_setConfig(config);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for (uint8_t i = 0; i < BUTTON_NUM; i++) {
+			buttons[i].state = STATE_IDLE;
+			buttons[i].ticks = 0;
+		}
+		lastState = button_getDebouncedState();
+		queueHead = 0;
+		queueTail = 0;
+		overflowCount = 0;
+	}
+
+	button_setStateCallback(&gesture_update);
+}
+
+void gesture_setConfig(const gestureConfig_t* config) {
+
+	/*
+	 * the thresholds are converted once here, so the tick only compares
+	 */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		longPressTicks = config->longPressMs / GESTURE_TICK_MS;
+		doubleClickTicks = config->doubleClickMs / GESTURE_TICK_MS;
+		repeatTicks = config->repeatMs / GESTURE_TICK_MS;
+	}
+
+	/*
+	 * a click waiting for its double click partner needs the tick, the
+	 * adaptive debouncer must not stop it before the time ran out
+	 */
+	button_setAdaptiveIdleTime(
+			(config->doubleClickMs < 0xFFFF - GESTURE_TICK_MS) ?
+					config->doubleClickMs + GESTURE_TICK_MS : 0xFFFF);
+}
+
+bool gesture_getEvent(gestureEvent_t* event) {
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (queueTail == queueHead) {
+			return false;
+		}
+		*event = queue[queueTail];
+		queueTail = (queueTail + 1) & GESTURE_QUEUE_MASK;
+	}
+	return true;
+}
+
+uint8_t gesture_getOverflowCount(void) {
+	return overflowCount;
+}
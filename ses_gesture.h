@@ -0,0 +1,79 @@
+#ifndef SES_GESTURE_H_
+#define SES_GESTURE_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ses_common.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* number of events the queue can hold, must be a power of two */
+#define GESTURE_QUEUE_SIZE              16
+
+/* default timing thresholds in ms */
+#define GESTURE_DEFAULT_LONG_PRESS_MS   800
+#define GESTURE_DEFAULT_DOUBLE_CLICK_MS 300
+#define GESTURE_DEFAULT_REPEAT_MS       200
+
+/* TYPES ********************************************************************/
+
+enum GestureTypes {
+	GESTURE_PRESS = 0,      ///< debounced press edge
+	GESTURE_RELEASE,        ///< debounced release edge
+	GESTURE_CLICK,          ///< short press, no second press within the double click time
+	GESTURE_DOUBLE_CLICK,   ///< second short press within the double click time
+	GESTURE_LONG_PRESS,     ///< button held for the long press time
+	GESTURE_REPEAT          ///< button still held, sent every repeat time after a long press
+};
+
+/**one recognized gesture
+ */
+typedef struct {
+	uint8_t button;         ///< element of the ButtonIds enum
+	uint8_t type;           ///< element of the GestureTypes enum
+	systemTime_t time;      ///< scheduler time in ms when it was recognized
+} gestureEvent_t;
+
+/**timing thresholds in ms, rounded down to the 5 ms debounce tick
+ */
+typedef struct {
+	uint16_t longPressMs;   ///< hold time for GESTURE_LONG_PRESS
+	uint16_t doubleClickMs; ///< max. gap between two clicks; 0 reports clicks at once
+	uint16_t repeatMs;      ///< GESTURE_REPEAT period; 0 disables auto-repeat
+} gestureConfig_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes the gesture recognizer on top of the debounced button state.
+ * button_init(true) has to be called to get the debounce tick.
+ *
+ * @param config  timing thresholds; NULL selects the defaults
+ */
+void gesture_init(const gestureConfig_t* config);
+
+/**
+ * Changes the timing thresholds.
+ *
+ * @param config  timing thresholds
+ */
+void gesture_setConfig(const gestureConfig_t* config);
+
+/**
+ * Takes the oldest event out of the queue.
+ * May be called from any context (interrupt or main program)
+ *
+ * @param event  written with the oldest event
+ * @return       false, if the queue was empty
+ */
+bool gesture_getEvent(gestureEvent_t* event);
+
+/**
+ * Number of events dropped because the queue was full.
+ */
+uint8_t gesture_getOverflowCount(void);
+
+#endif /* SES_GESTURE_H_ */
@@ -0,0 +1,56 @@
+#ifndef SES_GPIO_H_
+#define SES_GPIO_H_
+
+/*INCLUDES *******************************************************************/
+
+#include "ses_common.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/**
+ * Compile-time pin access. A pin is given as port register and bit number,
+ * usually through a pin definition holding both:
+ *
+ * example: #define LED_RED       PORTG, PG1
+ *          GPIO_TOGGLE(LED_RED);
+ *
+ * With constant arguments every access compiles to a single instruction on
+ * the low I/O ports (B to G): sbi/cbi for set and clear, sbis/sbic for
+ * reading and an out to PINx for toggling. These are atomic, so no
+ * interrupt can get lost between the read and the write of a
+ * read-modify-write sequence.
+ */
+
+/**drives the pin high (sbi)
+ */
+#define GPIO_SET(...)             GPIO_SET_(__VA_ARGS__)
+
+/**drives the pin low (cbi)
+ */
+#define GPIO_CLEAR(...)           GPIO_CLEAR_(__VA_ARGS__)
+
+/**inverts the pin by writing a 1 to PINx (ldi + out)
+ */
+#define GPIO_TOGGLE(...)          GPIO_TOGGLE_(__VA_ARGS__)
+
+/**true while the pin reads high (sbis/sbic)
+ */
+#define GPIO_READ(...)            GPIO_READ_(__VA_ARGS__)
+
+/**configures the pin as output (sbi on DDRx)
+ */
+#define GPIO_MAKE_OUTPUT(...)     GPIO_MAKE_OUTPUT_(__VA_ARGS__)
+
+/**configures the pin as input (cbi on DDRx), the pull-up is left unchanged
+ */
+#define GPIO_MAKE_INPUT(...)      GPIO_MAKE_INPUT_(__VA_ARGS__)
+
+/* the indirection expands pin definitions into port and pin first */
+#define GPIO_SET_(port, pin)          ((port) |= (1 << (pin)))
+#define GPIO_CLEAR_(port, pin)        ((port) &= ~(1 << (pin)))
+#define GPIO_TOGGLE_(port, pin)       (PIN_REGISTER(port) = (1 << (pin)))
+#define GPIO_READ_(port, pin)         ((PIN_REGISTER(port) & (1 << (pin))) != 0)
+#define GPIO_MAKE_OUTPUT_(port, pin)  (DDR_REGISTER(port) |= (1 << (pin)))
+#define GPIO_MAKE_INPUT_(port, pin)   (DDR_REGISTER(port) &= ~(1 << (pin)))
+
+#endif /* SES_GPIO_H_ */
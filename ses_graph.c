@@ -0,0 +1,190 @@
+/*
+ ***************************************************************************
+ ses_graph V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_graph draws trend charts (temperature, light, motor rpm) into the
+ framebuffer. A chart keeps one sample per column in a ring. A new sample
+ moves the chart area one column left with framebuffer_scrollLeft and
+ draws only the new column, computed as one byte per page and written
+ with framebuffer_setColumn. Nothing is sent to the display directly, the
+ framebuffer flush sends the byte columns that changed. A full height line
+ chart changes about 130 of them per sample, the flush task needs 9 of its
+ 5 ms steps for that; the display frame rate has not been measured.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_graph.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define SCALE_FRACTION_BITS      16
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+/*
+ * row of a value counted from the bottom, 0 to rows - 1
+ */
+static uint8_t graph_row(const graph_t* graph, int16_t value) {
+
+	uint8_t rows = graph->pages << 3;
+
+	/*
+	 * clamping first keeps the product below (rows - 1) * 2^16, it fits
+	 * in 32 bit for any range
+	 */
+	if (value <= graph->min) {
+		return 0;
+	}
+	if (value >= graph->max) {
+		return rows - 1;
+	}
+	return (uint8_t) ((((uint32_t) (uint16_t) (value - graph->min))
+			* graph->scale) >> SCALE_FRACTION_BITS);
+}
+
+/*
+ * writes one column with the rows low to high set (counted from the
+ * bottom), as one byte per page
+ */
+static void graph_drawSpan(const graph_t* graph, uint8_t column, uint8_t low,
+		uint8_t high) {
+
+	uint8_t rows = graph->pages << 3;
+
+	/* display rows count from the top, bit 0 of a page is its top row */
+	uint8_t top = rows - 1 - high;
+	uint8_t bottom = rows - 1 - low;
+
+	for (uint8_t p = 0; p < graph->pages; p++) {
+		uint8_t first = p << 3;
+		uint8_t bits = 0;
+
+		if (top <= first + 7 && bottom >= first) {
+			uint8_t from = (top > first) ? top - first : 0;
+			uint8_t to = (bottom < first + 7) ? bottom - first : 7;
+			bits = (uint8_t) (0xFF << from) & (uint8_t) (0xFF >> (7 - to));
+		}
+		framebuffer_setColumn(graph->page + p, graph->x + column, bits);
+	}
+}
+
+/*
+ * draws sample index (0 is the oldest valid one) into its column
+ */
+static void graph_drawSample(const graph_t* graph, uint8_t index) {
+
+	uint8_t position = graph->head + graph->width - graph->count + index;
+	if (position >= graph->width) {
+		position -= graph->width;
+	}
+
+	uint8_t column = graph->width - graph->count + index;
+	uint8_t row = graph_row(graph, graph->samples[position]);
+
+	if (graph->style == GRAPH_STYLE_BARS) {
+		graph_drawSpan(graph, column, 0, row);
+		return;
+	}
+
+	/*
+	 * the line is connected to the previous sample, so steep changes
+	 * do not leave gaps
+	 */
+	uint8_t previous = row;
+	if (index != 0) {
+		uint8_t before = (position == 0) ? graph->width - 1 : position - 1;
+		previous = graph_row(graph, graph->samples[before]);
+	}
+
+	if (previous < row) {
+		graph_drawSpan(graph, column, previous, row);
+	} else {
+		graph_drawSpan(graph, column, row, previous);
+	}
+}
+
+static void graph_clearColumns(const graph_t* graph, uint8_t from, uint8_t to) {
+
+	for (uint8_t p = 0; p < graph->pages; p++) {
+		for (uint8_t column = from; column < to; column++) {
+			framebuffer_setColumn(graph->page + p, graph->x + column, 0);
+		}
+	}
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+void graph_init(graph_t* graph, int16_t min, int16_t max) {
+
+	uint16_t rows = graph->pages << 3;
+
+	if (max <= min) {
+		max = min + 1;
+	}
+
+	graph->min = min;
+	graph->max = max;
+	graph->scale = (((uint32_t) (rows - 1)) << SCALE_FRACTION_BITS)
+			/ (uint16_t) (max - min);
+	graph->head = 0;
+	graph->count = 0;
+
+	graph_clearColumns(graph, 0, graph->width);
+}
+
+void graph_add(graph_t* graph, int16_t value) {
+
+	graph->samples[graph->head] = value;
+	graph->head++;
+	if (graph->head == graph->width) {
+		graph->head = 0;
+	}
+	if (graph->count < graph->width) {
+		graph->count++;
+	}
+
+	framebuffer_scrollLeft(graph->x, graph->width, graph->page, graph->pages,
+			1);
+	graph_drawSample(graph, graph->count - 1);
+}
+
+void graph_redraw(const graph_t* graph) {
+
+	graph_clearColumns(graph, 0, graph->width - graph->count);
+
+	for (uint8_t i = 0; i < graph->count; i++) {
+		graph_drawSample(graph, i);
+	}
+}
+
+void graph_drawLevel(uint8_t x, uint8_t width, uint8_t page, int16_t value,
+		int16_t min, int16_t max) {
+
+	if (width < 3) {
+		return;
+	}
+
+	uint8_t inner = width - 2;
+	uint8_t filled = 0;
+
+	if (max > min && value > min) {
+		if (value >= max) {
+			filled = inner;
+		} else {
+			filled = (uint8_t) (((int32_t) value - min) * inner
+					/ ((int32_t) max - min));
+		}
+	}
+
+	/* frame: full columns at the ends, top and bottom row in between */
+	framebuffer_setColumn(page, x, 0xFF);
+	for (uint8_t i = 0; i < inner; i++) {
+		framebuffer_setColumn(page, x + 1 + i, (i < filled) ? 0xFF : 0x81);
+	}
+	framebuffer_setColumn(page, x + width - 1, 0xFF);
+}
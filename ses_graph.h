@@ -0,0 +1,90 @@
+#ifndef SES_GRAPH_H_
+#define SES_GRAPH_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ses_common.h"
+#include "ses_framebuffer.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/**
+ * Static declaration helper, the sample ring holds one sample per column.
+ * The area is page aligned: pages is the height in 8 pixel rows.
+ *
+ * example: GRAPH_CHART(tempChart, 0, 122, 2, 2, GRAPH_STYLE_LINE);
+ *          full width trend in the lower half of the display
+ */
+#define GRAPH_CHART(name, x0, w, page0, h, chartStyle)                        \
+	static int16_t name##_samples[(w)];                                       \
+	static graph_t name = { .samples = name##_samples, .x = (x0),             \
+			.width = (w), .page = (page0), .pages = (h),                      \
+			.style = (chartStyle) }
+
+/* TYPES ********************************************************************/
+
+enum GraphStyles {
+	GRAPH_STYLE_LINE = 0,   ///< sparkline, samples connected vertically
+	GRAPH_STYLE_BARS        ///< one bar from the bottom per sample
+};
+
+/**scrolling chart, the newest sample is in the rightmost column
+ */
+typedef struct {
+	int16_t* samples;       ///< ring of the last width samples
+	uint8_t x;              ///< left column on the display
+	uint8_t width;          ///< number of columns and samples
+	uint8_t page;           ///< top page on the display
+	uint8_t pages;          ///< height in pages
+	uint8_t style;          ///< element of the GraphStyles enum
+	uint8_t head;           ///< next position to write in samples
+	uint8_t count;          ///< number of valid samples
+	int16_t min;            ///< value drawn at the bottom row
+	int16_t max;            ///< value drawn at the top row
+	uint32_t scale;         ///< rows per value step in Q16
+} graph_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Sets the value range of a chart, empties it and clears its area.
+ * Values outside the range are drawn at the top or bottom row.
+ *
+ * @param graph  chart declared with GRAPH_CHART
+ * @param min    value of the bottom row
+ * @param max    value of the top row, greater than min
+ */
+void graph_init(graph_t* graph, int16_t min, int16_t max);
+
+/**
+ * Adds a sample: the chart area is scrolled left by one column and only
+ * the new column is drawn.
+ *
+ * @param graph  chart
+ * @param value  new sample
+ */
+void graph_add(graph_t* graph, int16_t value);
+
+/**
+ * Draws the whole chart again from the sample ring, e.g. after a
+ * framebuffer_clear. In a full line chart the leftmost column loses its
+ * connection to the sample that already left the ring.
+ */
+void graph_redraw(const graph_t* graph);
+
+/**
+ * Draws a horizontal level bar with a frame, e.g. for the motor duty.
+ *
+ * @param x      left column
+ * @param width  number of columns including the frame, at least 3
+ * @param page   page of the bar, it is 8 pixels high
+ * @param value  level to draw
+ * @param min    value of an empty bar
+ * @param max    value of a full bar, greater than min
+ */
+void graph_drawLevel(uint8_t x, uint8_t width, uint8_t page, int16_t value,
+		int16_t min, int16_t max);
+
+#endif /* SES_GRAPH_H_ */
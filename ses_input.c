@@ -0,0 +1,95 @@
+/*
+ ***************************************************************************
+ ses_input V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_input holds the shared snapshot of all digital inputs (joystick button,
+ rotary button and both encoder channels). It is the only place reading
+ PINB and PING: the sampler tick on timer4 reads both ports once per tick
+ and packs the inputs into one byte, the rotary decoder gets that byte in
+ the same interrupt and the button debouncer and the query functions read
+ the cached byte.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_input.h"
+#include "ses_timer.h"
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static volatile uint8_t inputSnapshot = 0; /* last packed sample */
+static volatile bool samplerRunning = false;
+static volatile pInputTickCallback tickCallback = NULL;
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static inline uint8_t input_read(void) {
+
+	uint8_t portB = PIN_REGISTER(INPUT_BUTTON_PORT);
+	uint8_t portG = PIN_REGISTER(INPUT_ROTARY_B_PORT);
+	uint8_t snapshot = 0;
+
+	/* buttons are low active */
+	if (!(portB & (1 << INPUT_JOYSTICK_PIN))) {
+		snapshot |= (1 << INPUT_JOYSTICK);
+	}
+	if (!(portB & (1 << INPUT_ROTARY_BUTTON_PIN))) {
+		snapshot |= (1 << INPUT_ROTARY_BUTTON);
+	}
+	if (portB & (1 << INPUT_ROTARY_A_PIN)) {
+		snapshot |= (1 << INPUT_ROTARY_A);
+	}
+	if (portG & (1 << INPUT_ROTARY_B_PIN)) {
+		snapshot |= (1 << INPUT_ROTARY_B);
+	}
+
+	return snapshot;
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+void input_startSampler(pInputTickCallback callback) {
+
+	tickCallback = callback;
+	inputSnapshot = input_read();
+	samplerRunning = true;
+
+	timer4_start(INPUT_SAMPLE_PERIOD_US);
+}
+
+void input_stopSampler(void) {
+
+	timer4_stop();
+	samplerRunning = false;
+}
+
+uint8_t input_getSnapshot(void) {
+
+	if (!samplerRunning) {
+		inputSnapshot = input_read();
+	}
+	return inputSnapshot;
+}
+
+uint8_t input_refresh(void) {
+
+	uint8_t snapshot = input_read();
+
+	inputSnapshot = snapshot;
+	return snapshot;
+}
+
+ISR(TIMER4_COMPA_vect) {
+
+	uint8_t snapshot = input_read();
+	pInputTickCallback callback = tickCallback;
+
+	inputSnapshot = snapshot;
+	if (callback != NULL) {
+		callback(snapshot);
+	}
+}
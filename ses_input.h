@@ -0,0 +1,80 @@
+#ifndef SES_INPUT_H_
+#define SES_INPUT_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ses_common.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/**pins of all digital inputs of the board
+ */
+#define INPUT_BUTTON_PORT          PORTB
+#define INPUT_JOYSTICK_PIN         7
+#define INPUT_ROTARY_BUTTON_PIN    6
+#define INPUT_ROTARY_A_PORT        PORTB
+#define INPUT_ROTARY_A_PIN         5
+#define INPUT_ROTARY_B_PORT        PORTG
+#define INPUT_ROTARY_B_PIN         2
+
+/**bit positions in the snapshot. Buttons are 1 while pressed and use the
+ * positions of the ButtonIds enum, the encoder bits hold the pin levels so
+ * (snapshot >> INPUT_ROTARY_B) & 3 is (A << 1) | B.
+ */
+enum InputBits {
+	INPUT_JOYSTICK = 0,
+	INPUT_ROTARY_BUTTON,
+	INPUT_ROTARY_B,
+	INPUT_ROTARY_A
+};
+
+#define INPUT_BUTTON_MASK          ((1 << INPUT_JOYSTICK) | (1 << INPUT_ROTARY_BUTTON))
+#define INPUT_ROTARY_MASK          ((1 << INPUT_ROTARY_A) | (1 << INPUT_ROTARY_B))
+
+/* period of the input sampler (timer4), fast enough for the encoder */
+#define INPUT_SAMPLE_PERIOD_US     500
+
+/* TYPES ********************************************************************/
+
+/**called on every sampler tick with the new snapshot (interrupt context)
+ */
+typedef void (*pInputTickCallback)(uint8_t snapshot);
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Starts the input sampler: every INPUT_SAMPLE_PERIOD_US timer4 reads
+ * PINB and PING once, stores the packed snapshot and calls the callback
+ * with it. Only one tick consumer exists (the rotary decoder).
+ *
+ * @param callback  called after every sample, may be NULL
+ */
+void input_startSampler(pInputTickCallback callback);
+
+/**
+ * Stops the input sampler.
+ */
+void input_stopSampler(void);
+
+/**
+ * Returns the snapshot of all inputs. While the sampler runs this is the
+ * byte of its last tick (at most INPUT_SAMPLE_PERIOD_US old) and no port
+ * is read; without the sampler the ports are read once here, so a slower
+ * tick (the button debouncer) still takes all inputs from one read.
+ *
+ * @return bits of the InputBits enum
+ */
+uint8_t input_getSnapshot(void);
+
+/**
+ * Reads the ports now and replaces the snapshot. Only for the rare checks
+ * that must not miss an edge since the last tick, e.g. right before the
+ * adaptive debouncer stops its timer.
+ *
+ * @return the new snapshot
+ */
+uint8_t input_refresh(void);
+
+#endif /* SES_INPUT_H_ */
@@ -0,0 +1,55 @@
+#ifndef SES_LCDDRIVER_H_
+#define SES_LCDDRIVER_H_
+
+/*
+ * Bus level of the display, implemented in liblcd.a (ses_lcdDriver.o),
+ * which ships no header for it. Only ses_framebuffer uses it, the rest of
+ * the library draws through ses_framebuffer or ses_lcd. Writing here
+ * bypasses the pixel copy of ses_lcd, so lcd_setPixel must not be mixed
+ * with it.
+ *
+ * The panel has two controllers of 61 columns each. A data byte is one
+ * column of 8 pixels of the addressed page, bit 0 is the top pixel, and
+ * the controller moves to the next column after every data byte.
+ */
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+#define LCD_CONTROLLER_COLUMNS   61
+
+/* commands, the column address is sent as the command byte itself */
+#define LCD_COMMAND_PAGE         0xB8
+
+/* status bit set while the controller is busy */
+#define LCD_STATUS_BUSY          0x80
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Selects the controller the next commands and data go to.
+ *
+ * @param controller  0 for columns 0 to 60, 1 for columns 61 to 121
+ */
+void lcdDriver_selectController(uint8_t controller);
+
+/**
+ * @return status byte of the selected controller
+ */
+uint8_t lcdDriver_readStatus(void);
+
+/**
+ * Sends a command byte to the selected controller.
+ */
+void lcdDriver_writeCommand(uint8_t command);
+
+/**
+ * Writes a data byte at the current page and column of the selected
+ * controller.
+ */
+void lcdDriver_writeData(uint8_t data);
+
+#endif /* SES_LCDDRIVER_H_ */
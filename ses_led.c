@@ -8,6 +8,13 @@
  RED led on the board.It has functions to switch each led ON or OFF and
  also functions to toggle each led independently.
 
+ The brightness of the three LEDs can be dimmed by bit angle modulation
+ (BAM) on timer 5. A frame has one slot per brightness bit, slot k lasts
+ 2^k timer ticks and the LED is on in slot k if bit k of its brightness is
+ set. The pin levels of every slot are computed when a brightness changes,
+ so the ISR only toggles each port once per slot, whatever the number of
+ LEDs.
+
  ***************************************************************************
  */
 
@@ -15,6 +22,9 @@
 
 #include "ses_common.h"
 #include "ses_led.h"
+#include "ses_gpio.h"
+#include "ses_timer.h"
+#include "util/atomic.h"
 #include <stdbool.h>
 
 /*-----------------------------------------------------------
@@ -36,12 +46,62 @@
 #define LED_GREEN_PORT 		PORTF
 #define LED_GREEN_PIN       PF6
 
+#define LED_RED             LED_RED_PORT, LED_RED_PIN
+#define LED_YELLOW          LED_YELLOW_PORT, LED_YELLOW_PIN
+#define LED_GREEN           LED_GREEN_PORT, LED_GREEN_PIN
+
+/*
+ * the LEDs are spread over two ports, every slot needs one write to each.
+ * Timer 5 runs with prescaler 256, one tick is 16 us: the shortest slot is
+ * 256 cycles and a frame of 255 ticks is 4.08 ms (245 Hz).
+ */
+#define LED_DIM_PORT_F      PORTF
+#define LED_DIM_PORT_G      PORTG
+#define LED_DIM_TIMER_REGISTER      TCNT5
+#define LED_DIM_COMPARE_REGISTER    OCR5A
+
+/* TYPES *********************************************************************/
+
+/*
+ * pin levels of all dimmed LEDs in one slot, a set bit is a high pin
+ * (LED off, the LEDs are active low)
+ */
+typedef struct {
+	uint8_t portF;
+	uint8_t portG;
+} ledDimSlot_t;
+
 /* VARIBALE DEFINITION *******************************************************/
 
+static const uint8_t ledMasks[LED_NUM] = { (1 << LED_RED_PIN), (1
+		<< LED_YELLOW_PIN), (1 << LED_GREEN_PIN) };
+static const bool ledOnPortG[LED_NUM] = { true, false, false };
+
+/* compare value for each slot, slot k lasts 2^k ticks */
+static const uint8_t slotCompare[LED_DIM_DEPTH] = { 0, 1, 3, 7, 15, 31, 63,
+		127 };
+
+static uint8_t brightness[LED_NUM];
+
+/*
+ * the ISR plays one table while the other one is rebuilt, they are
+ * swapped at the start of a frame
+ */
+static ledDimSlot_t dimTables[2][LED_DIM_DEPTH];
+static volatile uint8_t activeTable = 0;
+static volatile bool tablePending = false;
+
+static volatile bool dimming = false;
+static volatile bool rebuilding = false;
+static volatile bool rebuildAgain = false;
+static uint8_t slot = 0;
+static uint8_t levelF;
+static uint8_t levelG;
+
 /* FUNCTION DEFINITION *******************************************************/
 
 void led_redInit(void) {
-	DDR_REGISTER(PORTG) |= (1 << LED_RED_PIN);
+	GPIO_MAKE_OUTPUT(LED_RED);
 
 	/* Initializing the RED led to
 	 * be OFF at the begining . */
@@ -51,22 +111,22 @@ void led_redInit(void) {
 }
 
 void led_redToggle(void) {
-	PORTG ^= (1 << LED_RED_PIN);
+	GPIO_TOGGLE(LED_RED);
 }
 
 void led_redOn(void) {
 
-	PORTG &= ~(1 << LED_RED_PIN);
+	GPIO_CLEAR(LED_RED);
 }
 
 void led_redOff(void) {
 
-	PORTG |= (1 << LED_RED_PIN);
+	GPIO_SET(LED_RED);
 
 }
 
 void led_yellowInit(void) {
-	DDR_REGISTER(PORTF) |= (1 << LED_YELLOW_PIN);
+	GPIO_MAKE_OUTPUT(LED_YELLOW);
 
 	/* Initializing the YELLOW led to
 	 * be OFF at the begining . */
@@ -77,25 +137,25 @@ void led_yellowInit(void) {
 
 void led_yellowToggle(void) {
 
-	PORTF ^= (1 << LED_YELLOW_PIN);
+	GPIO_TOGGLE(LED_YELLOW);
 
 }
 
 void led_yellowOn(void) {
 
-	PORTF &= ~(1 << LED_YELLOW_PIN);
+	GPIO_CLEAR(LED_YELLOW);
 
 }
 
 void led_yellowOff(void) {
 
-	PORTF |= (1 << LED_YELLOW_PIN);
+	GPIO_SET(LED_YELLOW);
 
 }
 
 void led_greenInit(void) {
 
-	DDR_REGISTER(PORTF) |= (1 << LED_GREEN_PIN);
+	GPIO_MAKE_OUTPUT(LED_GREEN);
 
 	/* Initializing the GREEN led to
 	 * be OFF at the begining . */
@@ -106,18 +166,225 @@ void led_greenInit(void) {
 
 void led_greenToggle(void) {
 
-	PORTF ^= (1 << LED_GREEN_PIN);
+	GPIO_TOGGLE(LED_GREEN);
 
 }
 
 void led_greenOn(void) {
 
-	PORTF &= ~(1 << LED_GREEN_PIN);
+	GPIO_CLEAR(LED_GREEN);
 
 }
 
 void led_greenOff(void) {
 
-	PORTF |= (1 << LED_GREEN_PIN);
+	GPIO_SET(LED_GREEN);
+
+}
+
+/*
+ * switches a LED without the modulation
+ */
+static void led_switch(uint8_t led, bool on) {
+
+	switch (led) {
+	case LED_ID_RED:
+		on ? led_redOn() : led_redOff();
+		break;
+	case LED_ID_YELLOW:
+		on ? led_yellowOn() : led_yellowOff();
+		break;
+	case LED_ID_GREEN:
+		on ? led_greenOn() : led_greenOff();
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * computes the pin levels of every slot from the brightness values
+ */
+static void led_dimBuild(ledDimSlot_t* table) {
+
+	uint8_t maskF = 0;
+	uint8_t maskG = 0;
+
+	for (uint8_t led = 0; led < LED_NUM; led++) {
+		if (ledOnPortG[led]) {
+			maskG |= ledMasks[led];
+		} else {
+			maskF |= ledMasks[led];
+		}
+	}
+
+	for (uint8_t bit = 0; bit < LED_DIM_DEPTH; bit++) {
+		table[bit].portF = maskF;
+		table[bit].portG = maskG;
+
+		for (uint8_t led = 0; led < LED_NUM; led++) {
+			if (brightness[led] & (1 << bit)) {
+				if (ledOnPortG[led]) {
+					table[bit].portG &= ~ledMasks[led];
+				} else {
+					table[bit].portF &= ~ledMasks[led];
+				}
+			}
+		}
+	}
+}
+
+/*
+ * switches the pins to the levels of the current slot and sets its length
+ */
+static inline void led_dimSlot(void) {
+
+	if (slot == 0 && tablePending) {
+		activeTable ^= 1;
+		tablePending = false;
+	}
+
+	const ledDimSlot_t* next = &dimTables[activeTable][slot];
+
+	PIN_REGISTER(LED_DIM_PORT_F) = next->portF ^ levelF;
+	PIN_REGISTER(LED_DIM_PORT_G) = next->portG ^ levelG;
+	levelF = next->portF;
+	levelG = next->portG;
+
+	LED_DIM_COMPARE_REGISTER = slotCompare[slot];
+
+	slot = (slot + 1) & (LED_DIM_DEPTH - 1);
+}
+
+/*
+ * timer 5 callback at the start of every slot: one toggle write per port
+ * and the length of the slot, the same work for any number of LEDs
+ */
+static void led_dimTick(void* param) {
+
+	/*
+	 * a late interrupt may have let the counter pass the end of a short
+	 * slot, it would then run through 0xFFFF. Such a slot is skipped and
+	 * the next one goes on from the count reached, which only shortens
+	 * it. Writing the counter instead would block a match at 0 in the
+	 * next timer clock, the end of slot 0.
+	 */
+	do {
+		led_dimSlot();
+	} while (slot != 0 && LED_DIM_TIMER_REGISTER > LED_DIM_COMPARE_REGISTER);
+
+	/*
+	 * more than a frame late: the counter is past the last slot. Its
+	 * compare value is not 0, so a restart cannot block its match.
+	 */
+	if (LED_DIM_TIMER_REGISTER > LED_DIM_COMPARE_REGISTER) {
+		LED_DIM_TIMER_REGISTER = 0;
+	}
+}
+
+void led_dimStart(void) {
+
+	led_redInit();
+	led_yellowInit();
+	led_greenInit();
+
+	led_dimBuild(dimTables[0]);
+	led_dimBuild(dimTables[1]);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		activeTable = 0;
+		tablePending = false;
+		slot = 0;
+
+		/* all LEDs are off (high) after the init */
+		levelF = (1 << LED_YELLOW_PIN) | (1 << LED_GREEN_PIN);
+		levelG = (1 << LED_RED_PIN);
+	}
+
+	dimming = true;
+	timer5_setCallback(&led_dimTick);
+	timer5_start();
+
+	/*
+	 * the first frame follows a dark slot as long as the last one, its
+	 * compare value is not 0, so the counter write cannot block the match
+	 */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		LED_DIM_TIMER_REGISTER = 0;
+		LED_DIM_COMPARE_REGISTER = slotCompare[LED_DIM_DEPTH - 1];
+	}
+}
+
+void led_dimStop(void) {
+
+	timer5_stop();
+	timer5_setCallback(NULL);
+	dimming = false;
+
+	led_redOff();
+	led_yellowOff();
+	led_greenOff();
+}
+
+void led_setBrightness(uint8_t led, uint8_t value) {
+
+	bool again;
+
+	if (led >= LED_NUM) {
+		return;
+	}
+
+	if (!dimming) {
+		brightness[led] = value;
+		led_switch(led, value != LED_OFF);
+		return;
+	}
+
+	if (brightness[led] == value) {
+		return;
+	}
+	brightness[led] = value;
+
+	/*
+	 * the ISR must not swap to the table while it is rebuilt. A call from
+	 * an interrupt during a rebuild only marks it, the running rebuild
+	 * then starts over and picks the new value up.
+	 */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (rebuilding) {
+			rebuildAgain = true;
+			return;
+		}
+		rebuilding = true;
+		tablePending = false;
+	}
+
+	do {
+		led_dimBuild(dimTables[activeTable ^ 1]);
+
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			again = rebuildAgain;
+			rebuildAgain = false;
+			if (!again) {
+				tablePending = true;
+				rebuilding = false;
+			}
+		}
+	} while (again);
+}
+
+uint8_t led_getBrightness(uint8_t led) {
+
+	if (led >= LED_NUM) {
+		return 0;
+	}
+	return brightness[led];
+}
 
+bool led_isDimming(void) {
+	return dimming;
 }
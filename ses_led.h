@@ -2,6 +2,22 @@
 #define SES_LED_H_
 
 #include <stdbool.h>
+#include <inttypes.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/* brightness bits, one BAM slot per bit */
+#define LED_DIM_DEPTH       8
+
+/* brightness of a LED that is switched fully on or off */
+#define LED_FULL            0xFF
+#define LED_OFF             0
+
+/* TYPES ********************************************************************/
+
+enum LedIds {
+	LED_ID_RED = 0, LED_ID_YELLOW, LED_ID_GREEN, LED_NUM
+};
 
 /* VARIABLES DECLERATION *******************************************************/
 
@@ -55,4 +71,37 @@ void led_greenOn(void);
  */
 void led_greenOff(void);
 
+/**
+ * Starts dimming all three LEDs by bit angle modulation on timer 5, which
+ * is not available for other uses while dimming. The dimmed LEDs are owned
+ * by the modulation, led_xxxOn/Off/Toggle must not be used on them.
+ */
+void led_dimStart(void);
+
+/**
+ * Stops dimming, releases timer 5 and switches all LEDs off.
+ */
+void led_dimStop(void);
+
+/**
+ * Sets the brightness of one LED. While dimming it is applied at the start
+ * of the next frame, otherwise the LED is switched on for any value above
+ * LED_OFF. May be called from task and interrupt context.
+ *
+ * @param led    element of the LedIds enum
+ * @param value  LED_OFF to LED_FULL
+ */
+void led_setBrightness(uint8_t led, uint8_t value);
+
+/**
+ * @param led  element of the LedIds enum
+ * @return     brightness set by led_setBrightness
+ */
+uint8_t led_getBrightness(uint8_t led);
+
+/**
+ * @return true, between led_dimStart and led_dimStop
+ */
+bool led_isDimming(void);
+
 #endif /* SES_LED_H_ */
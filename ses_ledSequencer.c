@@ -0,0 +1,235 @@
+/*
+ ***************************************************************************
+ ses_ledSequencer V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_ledSequencer plays LED patterns written as small byte code programs in
+ flash (set, clear, dim, wait, loop and sync). All players are run by one
+ periodic scheduler task, a playing pattern needs 7 bytes of RAM and the
+ patterns themselves need none.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_ledSequencer.h"
+#include "ses_scheduler.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* instructions one player may run per tick, stops a LOOP(0) without WAIT */
+#define LEDSEQ_MAX_STEPS        16
+
+#define LEDSEQ_LOOP_ARMED       0x80
+#define LEDSEQ_STATE_MASK       0x7F
+
+/* TYPES *********************************************************************/
+
+enum LedSeqStates {
+	STATE_IDLE = 0,         ///< no pattern or pattern ended
+	STATE_RUN,              ///< executing instructions
+	STATE_WAIT,             ///< waiting for wait to run out
+	STATE_SYNC              ///< waiting for the other players
+};
+
+typedef struct {
+	const uint8_t* pattern; ///< start of the pattern in flash
+	uint8_t pc;             ///< offset of the next instruction
+	uint8_t state;          ///< element of LedSeqStates, LEDSEQ_LOOP_ARMED
+	uint8_t loops;          ///< repetitions left of the LOOP
+	uint16_t wait;          ///< ms left of the WAIT
+} ledSeqPlayer_t;
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static ledSeqPlayer_t players[LEDSEQ_PLAYERS];
+
+static void ledSequencer_task(void* param);
+
+static taskDescriptor sequencerTask = { .task = &ledSequencer_task, .param =
+NULL, .expire = LEDSEQ_TICK_MS, .period = LEDSEQ_TICK_MS };
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static void ledSequencer_switch(uint8_t mask, bool on) {
+
+	for (uint8_t led = 0; led < LED_NUM; led++) {
+
+		if (!(mask & (1 << led))) {
+			continue;
+		}
+
+		/* switches the pin directly unless the LED is dimmed */
+		led_setBrightness(led, on ? LED_FULL : LED_OFF);
+	}
+}
+
+static inline uint8_t ledSequencer_fetch(const ledSeqPlayer_t* player,
+		uint8_t offset) {
+	return pgm_read_byte(player->pattern + player->pc + offset);
+}
+
+/*
+ * executes instructions until the player waits, syncs or ends
+ */
+static void ledSequencer_run(ledSeqPlayer_t* player) {
+
+	uint8_t steps = 0;
+
+	while ((player->state & LEDSEQ_STATE_MASK) == STATE_RUN
+			&& steps++ < LEDSEQ_MAX_STEPS) {
+
+		switch (ledSequencer_fetch(player, 0)) {
+		case LEDSEQ_OP_SET:
+			ledSequencer_switch(ledSequencer_fetch(player, 1), true);
+			player->pc += 2;
+			break;
+
+		case LEDSEQ_OP_CLEAR:
+			ledSequencer_switch(ledSequencer_fetch(player, 1), false);
+			player->pc += 2;
+			break;
+
+		case LEDSEQ_OP_DIM: {
+			uint8_t led = ledSequencer_fetch(player, 1);
+			if (led < LED_NUM) {
+				led_setBrightness(led, ledSequencer_fetch(player, 2));
+			}
+			player->pc += 3;
+			break;
+		}
+
+		case LEDSEQ_OP_WAIT:
+			player->wait = ledSequencer_fetch(player, 1)
+					| ((uint16_t) ledSequencer_fetch(player, 2) << 8);
+			player->pc += 3;
+			if (player->wait != 0) {
+				player->state = (player->state & LEDSEQ_LOOP_ARMED)
+						| STATE_WAIT;
+			}
+			break;
+
+		case LEDSEQ_OP_LOOP: {
+			uint8_t count = ledSequencer_fetch(player, 1);
+
+			if (count == 0) {
+				player->pc = 0;
+				break;
+			}
+			if (!(player->state & LEDSEQ_LOOP_ARMED)) {
+				player->loops = count;
+				player->state |= LEDSEQ_LOOP_ARMED;
+			}
+			if (player->loops != 0) {
+				player->loops--;
+				player->pc = 0;
+			} else {
+				player->state &= ~LEDSEQ_LOOP_ARMED;
+				player->pc += 2;
+			}
+			break;
+		}
+
+		case LEDSEQ_OP_SYNC:
+			player->pc += 1;
+			player->state = (player->state & LEDSEQ_LOOP_ARMED) | STATE_SYNC;
+			break;
+
+		case LEDSEQ_OP_END:
+		default:
+			player->state = STATE_IDLE;
+			break;
+		}
+	}
+}
+
+static void ledSequencer_task(void* param) {
+
+	uint8_t syncing = 0;
+	uint8_t busy = 0;
+
+	for (uint8_t i = 0; i < LEDSEQ_PLAYERS; i++) {
+		ledSeqPlayer_t* player = &players[i];
+
+		if ((player->state & LEDSEQ_STATE_MASK) == STATE_WAIT) {
+			if (player->wait > LEDSEQ_TICK_MS) {
+				player->wait -= LEDSEQ_TICK_MS;
+			} else {
+				player->wait = 0;
+				player->state = (player->state & LEDSEQ_LOOP_ARMED)
+						| STATE_RUN;
+			}
+		}
+
+		ledSequencer_run(player);
+
+		switch (player->state & LEDSEQ_STATE_MASK) {
+		case STATE_SYNC:
+			syncing++;
+			break;
+		case STATE_RUN:
+		case STATE_WAIT:
+			busy++;
+			break;
+		default:
+			break;
+		}
+	}
+
+	/*
+	 * the last player that reaches its SYNC releases all of them
+	 */
+	if (syncing != 0 && busy == 0) {
+		for (uint8_t i = 0; i < LEDSEQ_PLAYERS; i++) {
+			ledSeqPlayer_t* player = &players[i];
+
+			if ((player->state & LEDSEQ_STATE_MASK) == STATE_SYNC) {
+				player->state = (player->state & LEDSEQ_LOOP_ARMED)
+						| STATE_RUN;
+				ledSequencer_run(player);
+			}
+		}
+	}
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+void ledSequencer_init(void) {
+
+	for (uint8_t i = 0; i < LEDSEQ_PLAYERS; i++) {
+		players[i].state = STATE_IDLE;
+	}
+
+	scheduler_add(&sequencerTask);
+}
+
+bool ledSequencer_play(uint8_t player, const uint8_t* pattern) {
+
+	if (player >= LEDSEQ_PLAYERS || pattern == NULL) {
+		return false;
+	}
+
+	players[player].pattern = pattern;
+	players[player].pc = 0;
+	players[player].loops = 0;
+	players[player].wait = 0;
+	players[player].state = STATE_RUN;
+	return true;
+}
+
+void ledSequencer_stop(uint8_t player) {
+
+	if (player < LEDSEQ_PLAYERS) {
+		players[player].state = STATE_IDLE;
+	}
+}
+
+bool ledSequencer_isPlaying(uint8_t player) {
+
+	if (player >= LEDSEQ_PLAYERS) {
+		return false;
+	}
+	return players[player].state != STATE_IDLE;
+}
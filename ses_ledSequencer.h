@@ -0,0 +1,91 @@
+#ifndef SES_LEDSEQUENCER_H_
+#define SES_LEDSEQUENCER_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include "ses_common.h"
+#include "ses_led.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* number of patterns that can play at the same time */
+#ifndef LEDSEQ_PLAYERS
+#define LEDSEQ_PLAYERS          3
+#endif
+
+/* period of the sequencer task, waits are rounded up to it */
+#ifndef LEDSEQ_TICK_MS
+#define LEDSEQ_TICK_MS          10
+#endif
+
+/* LED masks for LEDSEQ_SET and LEDSEQ_CLEAR */
+#define LEDSEQ_RED              (1 << LED_ID_RED)
+#define LEDSEQ_YELLOW           (1 << LED_ID_YELLOW)
+#define LEDSEQ_GREEN            (1 << LED_ID_GREEN)
+#define LEDSEQ_ALL              (LEDSEQ_RED | LEDSEQ_YELLOW | LEDSEQ_GREEN)
+
+/**
+ * Instructions of a pattern. A pattern is a byte array in flash:
+ *
+ * example:
+ * static const uint8_t heartbeat[] PROGMEM = {
+ *     LEDSEQ_SET(LEDSEQ_RED), LEDSEQ_WAIT(100),
+ *     LEDSEQ_CLEAR(LEDSEQ_RED), LEDSEQ_WAIT(900),
+ *     LEDSEQ_LOOP(0)
+ * };
+ */
+#define LEDSEQ_SET(mask)        LEDSEQ_OP_SET, (mask)
+#define LEDSEQ_CLEAR(mask)      LEDSEQ_OP_CLEAR, (mask)
+#define LEDSEQ_DIM(led, level)  LEDSEQ_OP_DIM, (led), (level)
+#define LEDSEQ_WAIT(ms)         LEDSEQ_OP_WAIT, ((ms) & 0xFF), (((ms) >> 8) & 0xFF)
+#define LEDSEQ_LOOP(count)      LEDSEQ_OP_LOOP, (count)
+#define LEDSEQ_SYNC()           LEDSEQ_OP_SYNC
+#define LEDSEQ_END()            LEDSEQ_OP_END
+
+/* TYPES ********************************************************************/
+
+enum LedSeqOpcodes {
+	LEDSEQ_OP_END = 0,      ///< stop the pattern, the LEDs stay as they are
+	LEDSEQ_OP_SET,          ///< switch the LEDs of the mask on
+	LEDSEQ_OP_CLEAR,        ///< switch the LEDs of the mask off
+	LEDSEQ_OP_DIM,          ///< set the brightness of one LED (led_dimStart)
+	LEDSEQ_OP_WAIT,         ///< wait a 16 bit time in ms
+	LEDSEQ_OP_LOOP,         ///< restart the pattern count more times, 0 forever
+	LEDSEQ_OP_SYNC          ///< wait until every playing pattern reached a SYNC
+};
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Adds the sequencer task to the scheduler. All players share this task.
+ */
+void ledSequencer_init(void);
+
+/**
+ * Starts a pattern on a player, a running pattern is replaced.
+ * SET and CLEAR use the brightness while the LEDs are dimmed.
+ * May be called from task context only, like ledSequencer_stop.
+ *
+ * @param player   0 to LEDSEQ_PLAYERS - 1
+ * @param pattern  pattern in flash (PROGMEM)
+ * @return         false, if the player does not exist
+ */
+bool ledSequencer_play(uint8_t player, const uint8_t* pattern);
+
+/**
+ * Stops the pattern of a player, the LEDs stay as they are.
+ *
+ * @param player   0 to LEDSEQ_PLAYERS - 1
+ */
+void ledSequencer_stop(uint8_t player);
+
+/**
+ * @param player   0 to LEDSEQ_PLAYERS - 1
+ * @return         true, if the player has not reached the end of its pattern
+ */
+bool ledSequencer_isPlaying(uint8_t player);
+
+#endif /* SES_LEDSEQUENCER_H_ */
@@ -5,6 +5,11 @@
  This file is part of the SES_TUHH library.
 
  ses_motorFrequency is a library that allows reading the value of the Motor Frequency.
+ The pulse periods are measured by the input capture tachometer (ses_tacho), the
+ conversion to a frequency is done when a task reads it. A scheduler task
+ acts as a watchdog that every pulse pushes back; it reports a stall when
+ the pulses stop. Mean, variance, min and max of the speed over a sliding
+ window are updated for every pulse, so reading them costs only a copy.
 
  ***************************************************************************
  */
@@ -16,134 +21,354 @@
 #include "ses_timer.h"
 #include "ses_lcd.h"
 #include "util/atomic.h"
+#include "ses_filter.h"
+#include "ses_tacho.h"
+#include "ses_reciprocal.h"
+#include "ses_scheduler.h"
 
 /* DEFINES & MACROS **********************************************************/
 
-#define EXTERNAL_INTERUPT_MASK_REGISTER   	   EIMSK
-#define EXTERNAL_INTERUPT_CONTROL_REGISTER	   EICRA
-#define EXTERNAL_INTERRUPT_FLAG_REGISTER	   EIFR
-#define TIMER5							   	   TCNT5
-#define ARRAY_SIZE                             21
-#define TIMER_RESOLUTION                       62500
-#define SPIKES                                  5
-#define SCALE_FACTOR                           100000
+#define SPIKES                                  5 /* pulses per revolution */
+#define MAX_MEDIAN_PERIOD                       0xFFFF
 
-/* Variables **********************************************************/
+/*
+ * rpm = TACHO_TICKS_PER_SEC * 60 / SPIKES / period, the numerator does not fit
+ * into 16 bit and is split into RPM_NUMERATOR * 2^RPM_SCALE
+ */
+#define RPM_SCALE                               6
+#define RPM_NUMERATOR                           (TACHO_TICKS_PER_SEC * 60 / SPIKES / (1 << RPM_SCALE))
 
-uint8_t spikesCounter = SPIKES;
+#define TACHO_TICKS_PER_MS                      (TACHO_TICKS_PER_SEC / 1000)
 
-uint8_t arrayCounter = 0;
+#define STATS_WINDOW                            (1 << MOTOR_STATS_WINDOW_LOG2)
+#define STATS_MASK                              (STATS_WINDOW - 1)
 
-uint8_t arrayLength = ARRAY_SIZE;
+#if MOTOR_STATS_WINDOW_LOG2 > 7
+#error "MOTOR_STATS_WINDOW_LOG2 must not exceed 7"
+#endif
 
-uint8_t array[ARRAY_SIZE];
+/* TYPES *********************************************************************/
 
-bool motorOn = false;
+/*
+ * monotonic deque of (value, sequence) pairs kept as a ring, the front
+ * holds the extreme value of the window
+ */
+typedef struct {
+	uint16_t values[STATS_WINDOW];
+	uint8_t sequence[STATS_WINDOW];
+	uint8_t head;
+	uint8_t count;
+} statsDeque_t;
 
-uint16_t frequency = 0;
+/* Variables **********************************************************/
+
+/*
+ * sliding window of the recent pulse periods, kept sorted on every insert
+ * so the median can be read directly. The median of the periods gives the
+ * median frequency, only one conversion is needed when it is read.
+ */
+FILTER_MEDIAN(periodMedian, MOTOR_MEDIAN_WINDOW);
+
+volatile bool motorOn = false;
+
+/*
+ * sliding window statistics of the speed in rpm, updated for every pulse.
+ * sum is the exact window sum, so sum is also the mean with
+ * MOTOR_STATS_WINDOW_LOG2 fraction bits. scaledM2 is the sum of squared
+ * deviations from the mean, scaled by the window size to stay an integer.
+ */
+static uint16_t statsWindow[STATS_WINDOW];
+static uint8_t statsIndex = 0;
+static uint8_t statsSequence = 0;
+static bool statsPrimed = false;
+static uint32_t statsSum = 0;
+static int64_t statsScaledM2 = 0;
+static statsDeque_t statsMin;
+static statsDeque_t statsMax;
+static motorStats_t statsSnapshot;
+
+static volatile uint16_t stallTimeoutMs = MOTOR_STALL_TIMEOUT_MS;
+static volatile uint8_t stallCount = 0;
+static volatile pMotorEventCallback myStallCallback = NULL;
+
+static void motorFrequency_watchdog(void* param);
+
+/*
+ * the watchdog only fires when no pulse pushed its expire time back
+ * for a whole timeout
+ */
+static taskDescriptor watchdogTask = { .task = &motorFrequency_watchdog,
+		.param = NULL, .expire = MOTOR_STALL_TIMEOUT_MS, .period =
+		MOTOR_STALL_TIMEOUT_MS };
 
 /*-------------------------------------------------------------
  * Implementation of functions defined in ses_motorFrequency.c *
  *-------------------------------------------------------------*/
 
-void motorFrequency_init() {
+/*
+ * revolutions per second for a pulse period in tacho ticks, called in task
+ * context only. The reciprocal routine avoids the 32 bit division.
+ */
+static uint16_t motorFrequency_fromPeriod(uint32_t period) {
 
-	DDR_REGISTER(PORTD) &= ~(1 << PD0);
+	if (period == 0) {
+		return 0;
+	}
+	return reciprocal_divide(TACHO_TICKS_PER_SEC / SPIKES, period);
+}
 
-	PORTD |= (1 << PD0);
+/*
+ * revolutions per minute for a pulse period in tacho ticks, saturated to 16 bit
+ */
+static uint16_t motorFrequency_rpmFromPeriod(uint32_t period) {
 
-	/*
-	 * disable interrupt to prevent accidental call during setup
-	 */
+	uint32_t rpm;
 
-	EXTERNAL_INTERUPT_MASK_REGISTER &= ~(1 << INT0);
+	if (period == 0) {
+		return 0;
+	}
+	rpm = reciprocal_divideScaled(RPM_NUMERATOR, period, RPM_SCALE);
+	return (rpm > 0xFFFF) ? 0xFFFF : (uint16_t) rpm;
+}
 
-	/*
-	 * trigger raising edges of signal
-	 */
+/*
+ * A motor slowing down gives no pulse that reports it. The time since the
+ * last pulse is a lower bound for the running period, so the speed read
+ * from a stored period decays toward zero as soon as this time exceeds it.
+ */
+static uint32_t motorFrequency_decayPeriod(uint32_t period) {
 
-	EXTERNAL_INTERUPT_CONTROL_REGISTER |= (1 << ISC00);
+	uint32_t elapsed = tacho_getElapsed();
 
-	EXTERNAL_INTERUPT_CONTROL_REGISTER |= (1 << ISC01);
+	return (elapsed > period) ? elapsed : period;
+}
+
+/*
+ * adds a sample to a monotonic deque and drops the samples that left the
+ * window. Every sample enters and leaves once, so this is O(1) amortized.
+ */
+static void motorFrequency_dequePush(statsDeque_t* deque, uint16_t value,
+		bool keepMax) {
 
 	/*
-	 * clear pending interrupt (INT2)
+	 * the front leaves once it is STATS_WINDOW samples old. This has to
+	 * happen before the insert, a full ring would overwrite the front.
 	 */
+	if ((deque->count != 0)
+			&& ((uint8_t) (statsSequence - deque->sequence[deque->head])
+					>= STATS_WINDOW)) {
+		deque->head = (deque->head + 1) & STATS_MASK;
+		deque->count--;
+	}
 
-	EXTERNAL_INTERRUPT_FLAG_REGISTER |= (1 << INTF0);
+	/* drop the samples from the back that can never be the extreme again */
+	while (deque->count != 0) {
+		uint16_t back = deque->values[(deque->head + deque->count - 1)
+				& STATS_MASK];
+
+		if (keepMax ? (back > value) : (back < value)) {
+			break;
+		}
+		deque->count--;
+	}
+
+	uint8_t slot = (deque->head + deque->count) & STATS_MASK;
+	deque->values[slot] = value;
+	deque->sequence[slot] = statsSequence;
+	deque->count++;
+}
+
+/*
+ * sliding window update in constant time, called from the capture ISR
+ */
+static void motorFrequency_statsAdd(uint16_t rpm) {
+
+	if (!statsPrimed) {
+		/*
+		 * the first sample fills the whole window, so mean and variance
+		 * are valid at once
+		 */
+		for (uint8_t i = 0; i < STATS_WINDOW; i++) {
+			statsWindow[i] = rpm;
+		}
+		statsSum = (uint32_t) rpm << MOTOR_STATS_WINDOW_LOG2;
+		statsScaledM2 = 0;
+		statsMin.count = 0;
+		statsMax.count = 0;
+		statsPrimed = true;
+	} else {
+		/*
+		 * Welford update for a sliding window: the oldest sample leaves
+		 * while the new one enters,
+		 * M2 += (x - old) * ((x - newMean) + (old - oldMean)).
+		 * With the means kept as sums the update is exact and M2 does
+		 * not drift.
+		 */
+		uint16_t old = statsWindow[statsIndex];
+		uint32_t oldSum = statsSum;
+		int32_t delta = (int32_t) rpm - old;
+		int32_t deviation;
+
+		statsWindow[statsIndex] = rpm;
+		statsSum += delta;
+
+		deviation = ((int32_t) rpm << MOTOR_STATS_WINDOW_LOG2)
+				- (int32_t) statsSum
+				+ ((int32_t) old << MOTOR_STATS_WINDOW_LOG2)
+				- (int32_t) oldSum;
+		statsScaledM2 += (int64_t) delta * deviation;
+	}
+	statsIndex = (statsIndex + 1) & STATS_MASK;
+
+	motorFrequency_dequePush(&statsMin, rpm, false);
+	motorFrequency_dequePush(&statsMax, rpm, true);
+	statsSequence++;
 
 	/*
-	 * enable interrupt
+	 * the snapshot is complete after every sample, a reader only copies it
 	 */
+	statsSnapshot.mean = (uint16_t) (statsSum >> MOTOR_STATS_WINDOW_LOG2);
+	statsSnapshot.variance = (uint32_t) (statsScaledM2
+			>> (2 * MOTOR_STATS_WINDOW_LOG2));
+	statsSnapshot.min = statsMin.values[statsMin.head];
+	statsSnapshot.max = statsMax.values[statsMax.head];
+}
 
-	EXTERNAL_INTERUPT_MASK_REGISTER |= (1 << INT0);
+static void motorFrequency_statsReset(void) {
 
-	sei();
+	statsPrimed = false;
+	statsSnapshot.mean = 0;
+	statsSnapshot.variance = 0;
+	statsSnapshot.min = 0;
+	statsSnapshot.max = 0;
 }
 
-void motorSet(bool value) {
+/*
+ * runs when the watchdog expired, i.e. no pulse for stallTimeoutMs
+ */
+static void motorFrequency_watchdog(void* param) {
 
-	motorOn = value;
+	uint32_t elapsed = tacho_getElapsed();
+
+	/*
+	 * a pulse may have arrived after the task was marked for execution
+	 */
+	if (!motorOn || elapsed < (uint32_t) stallTimeoutMs * TACHO_TICKS_PER_MS) {
+		return;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		motorOn = false;
+		filter_reset(FILTER_TYPE_MEDIAN, &periodMedian);
+		motorFrequency_statsReset();
+		if (stallCount != 0xFF) {
+			stallCount++;
+		}
+	}
+
+	led_setBrightness(LED_ID_GREEN, LED_FULL);
+
+	pMotorEventCallback callback = myStallCallback;
+	if (callback != NULL) {
+		callback();
+	}
 }
 
-uint16_t motorFrequency_getRecent() {
+/*
+ * called from the capture ISR for every pulse
+ */
+static void motorFrequency_capture(uint32_t period) {
 
-	uint16_t timerValue;
+	/*
+	 * through the brightness API, the LEDs may be owned by the dimming.
+	 * Green only changes after a stall, the yellow toggle costs one table
+	 * rebuild per pulse while dimming.
+	 */
+	led_setBrightness(LED_ID_GREEN, LED_OFF);
+	led_setBrightness(LED_ID_YELLOW,
+			(led_getBrightness(LED_ID_YELLOW) == LED_OFF) ? LED_FULL : LED_OFF);
+
+	/*
+	 * pushes the watchdog back, the scheduler update runs in an ISR as
+	 * well, so the write cannot interleave with it
+	 */
+	watchdogTask.expire = stallTimeoutMs;
 
 	if (!motorOn) {
 		/*
-		 * If the motor is off ,frequency should be zero
+		 * the first period after a stall spans the standstill
 		 */
-		return 0;
+		motorSet(true);
+		return;
+	}
 
-	} else {
+	/*
+	 * the period replaces the oldest one in the median window,
+	 * binary search and one shift keep the window sorted
+	 */
+	if (period > MAX_MEDIAN_PERIOD) {
+		period = MAX_MEDIAN_PERIOD;
+	}
+	filter_medianProcess(&periodMedian, (filter_sample_t) period);
 
-		if (spikesCounter == SPIKES) {
+	motorFrequency_statsAdd(motorFrequency_rpmFromPeriod(period));
+}
 
-			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-			{
+void motorFrequency_init() {
 
-				/*
-				 * Timer5 starts
-				 */
+	tacho_setCaptureCallback(&motorFrequency_capture);
 
-				TCNT5 = 0;
-			}
-		}
+	tacho_init();
 
-		if (spikesCounter >= 0) {
-			spikesCounter--;
-		}
+	scheduler_add(&watchdogTask);
+}
 
-		if (spikesCounter == 0) {
+void motorFrequency_setStallTimeout(uint16_t timeoutMs) {
 
-			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-			{
+	if (timeoutMs == 0) {
+		timeoutMs = MOTOR_STALL_TIMEOUT_MS;
+	}
 
-				/*
-				 * Timer for One revolution is calculated
-				 */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		stallTimeoutMs = timeoutMs;
+		watchdogTask.period = timeoutMs;
+		watchdogTask.expire = timeoutMs;
+	}
+}
 
-				timerValue = SCALE_FACTOR * TCNT5 / TIMER_RESOLUTION;
+void motorFrequency_setStallCallback(pMotorEventCallback cb) {
+	myStallCallback = cb;
+}
 
-			}
+uint8_t motorFrequency_getStallCount() {
+	return stallCount;
+}
 
-			/*
-			 * frequency is calculated
-			 */
-			frequency = SCALE_FACTOR / timerValue;
-		}
+void motorSet(bool value) {
 
-	}
+	motorOn = value;
+}
+
+uint16_t motorFrequency_getRecent() {
+
+	if (!motorOn) {
+		/*
+		 * If the motor is off ,frequency should be zero
+		 */
+		return 0;
+
+	} else {
 
-	return frequency;
+		return motorFrequency_fromPeriod(
+				motorFrequency_decayPeriod(tacho_getPeriod()));
+	}
 }
 
 uint16_t motorFrequency_getMedian() {
 
-	uint16_t temp = 0;
 	uint16_t median = 0;
-	uint16_t arrayCopy[arrayLength];
 
 	if (!motorOn) {
 		/*
@@ -153,61 +378,40 @@ uint16_t motorFrequency_getMedian() {
 
 	} else {
 		/*
-		 * Copy the Array to avoid calculation mistakes
+		 * the window is sorted by the ISR on every insert, only the
+		 * middle entry has to be read (atomically, it is 16 bit)
 		 */
 		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 		{
-			for (int i = 0; i < arrayLength; i++) {
-				arrayCopy[i] = array[i];
-			}
+			median = filter_medianGet(&periodMedian);
 		}
 
-		for (int i = 0; i < arrayLength; i++) {
-			for (int j = 0; j < arrayLength - 1; j++) {
-				if (arrayCopy[j] > arrayCopy[j + 1]) {
-					temp = arrayCopy[j];
-					arrayCopy[j] = arrayCopy[j + 1];
-					arrayCopy[j + 1] = temp;
-				}
-			}
-		}
-
-		/*
-		 * function to calculate the median of the array of odd elements
-		 */
-
-		median = arrayCopy[arrayLength / 2];
-
-		return median;
+		return motorFrequency_fromPeriod(motorFrequency_decayPeriod(median));
 
 	}
 
 }
 
-ISR(INT0_vect) {
-
-	led_greenOff();
-
-	motorSet(true);
+uint16_t motorFrequency_getMedianRpm() {
 
-	/*
-	 * If array is full , we
-	 * go back to the first element
-	 */
+	uint16_t median = 0;
 
-	if (arrayCounter == arrayLength) {
-		arrayCounter = 0;
+	if (!motorOn) {
+		return 0;
 	}
 
-	led_yellowToggle();
-
-	/*
-	 * motor frequency is saved in array
-	 */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		median = filter_medianGet(&periodMedian);
+	}
 
-	array[arrayCounter] = motorFrequency_getRecent();
+	return motorFrequency_rpmFromPeriod(motorFrequency_decayPeriod(median));
+}
 
-	arrayCounter++;
+void motorFrequency_getStats(motorStats_t* snapshot) {
 
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*snapshot = statsSnapshot;
+	}
 }
-
@@ -5,10 +5,82 @@
 #include <avr/io.h>
 #include "ses_common.h"
 
+/* DEFINES & MACROS **********************************************************/
+
+/* number of recent pulse periods for motorFrequency_getMedian, should be odd */
+#ifndef MOTOR_MEDIAN_WINDOW
+#define MOTOR_MEDIAN_WINDOW 21
+#endif
+
+/* time without a pulse in ms after which the motor counts as stalled */
+#ifndef MOTOR_STALL_TIMEOUT_MS
+#define MOTOR_STALL_TIMEOUT_MS 500
+#endif
+
+/* log2 of the number of recent pulses in the speed statistics */
+#ifndef MOTOR_STATS_WINDOW_LOG2
+#define MOTOR_STATS_WINDOW_LOG2 4
+#endif
+
+/* TYPES ********************************************************************/
+
+/**speed statistics over the last 2^MOTOR_STATS_WINDOW_LOG2 pulses, all in rpm
+ */
+typedef struct {
+	uint16_t mean;          ///< mean speed, rounded down
+	uint32_t variance;      ///< population variance in rpm^2, rounded down
+	uint16_t min;           ///< lowest speed in the window
+	uint16_t max;           ///< highest speed in the window
+} motorStats_t;
+
+/**type of function pointer for motor events, called in task context */
+typedef void (*pMotorEventCallback)(void);
+
 /* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes the tachometer and adds the stall watchdog to the scheduler.
+ * Without pulses the reported speed decays toward zero; after the stall
+ * timeout the motor counts as stopped and the speed reads 0.
+ */
 void motorFrequency_init();
 uint16_t motorFrequency_getRecent();
 uint16_t motorFrequency_getMedian();
+
+/**
+ * Median speed in revolutions per minute, same window as motorFrequency_getMedian
+ * but without its rounding to whole revolutions per second.
+ */
+uint16_t motorFrequency_getMedianRpm();
 void motorSet(bool);
 
+/**
+ * Sets the time without a pulse after which the motor counts as stalled.
+ *
+ * @param timeoutMs  timeout in ms, 0 selects MOTOR_STALL_TIMEOUT_MS
+ */
+void motorFrequency_setStallTimeout(uint16_t timeoutMs);
+
+/**
+ * Sets a function to be called once when the motor stalls.
+ *
+ * @param cb  pointer to the callback function; if NULL, no callback
+ *            will be executed.
+ */
+void motorFrequency_setStallCallback(pMotorEventCallback cb);
+
+/**
+ * Number of stalls detected since the start, saturates at 255.
+ */
+uint8_t motorFrequency_getStallCount();
+
+/**
+ * Copies the speed statistics atomically. They are updated for every pulse,
+ * nothing is computed here. All fields are 0 until the first pulse after
+ * the start or a stall.
+ *
+ * @param snapshot  written with the current statistics
+ */
+void motorFrequency_getStats(motorStats_t* snapshot);
+
 #endif /* SES_MOTORFREQUENCY_H_ */
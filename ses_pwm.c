@@ -9,6 +9,19 @@
  Thus, a PWM signal with a fixed frequency, but adjustable duty cycle can be used to control the motor
  speed.
 
+ With PWM_16BIT the motor is driven from OC3B (PE4) of the 16 bit timer 3
+ instead, with configurable TOP (frequency and resolution) and a phase
+ correct mode. This module is then the only one that writes TCCR3A/B; the
+ input capture unit of the same timer stays available to ses_tacho, whose
+ timestamps are extended with a timebase kept by the overflow interrupt.
+
+ The ramp engine moves the duty cycle along a linear or S-curve profile.
+ It is stepped in the timer 2 interrupt from the 1 ms scheduler tick, so it
+ needs no interrupt at the PWM frequency and is not delayed by long tasks.
+ Only the completion callback runs as a task. Between ramps the tick
+ callback is removed.
+
+
  ***************************************************************************
  */
 
@@ -16,11 +29,193 @@
 
 #include "ses_pwm.h"
 #include "ses_timer.h"
+#include "ses_scheduler.h"
+#include "util/atomic.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* ramp position runs from 0 to RAMP_END, the profile uses 15 bit of it */
+#define RAMP_POSITION_BITS               24
+#define RAMP_END                         (1UL << RAMP_POSITION_BITS)
+#define RAMP_PROFILE_BITS                15
+
+/* the ramp moves the duty cycle once per scheduler tick */
+#define RAMP_PERIOD_MS                   1
+
+#ifdef PWM_16BIT
+
+#define PWM_OUTPUT_PORT                  PORTE
+#define PWM_OUTPUT_PIN                   PE4
+
+#define TIMER3_REGISTER					 TCNT3
+#define TIMER3_CONTROL_REGISTER_3A   	 TCCR3A
+#define TIMER3_CONTROL_REGISTER_3B   	 TCCR3B
+#define TIMER3_TOP_REGISTER              OCR3A
+#define TIMER3_COMPARE_REGISTER          OCR3B
+#define TIMER_INTERRUPT_MASK_3		 	 TIMSK3
+#define TIMER_INTERRUPT_FLAG_REGISTER3	 TIFR3
+#define POWER_REDUCTION_REGISTER_1    	 PRR1
+
+#define PWM_MIN_TOP                      3
+
+/* input capture settings of ses_tacho, kept when the PWM is reconfigured */
+#define CAPTURE_CONTROL_BITS             ((1 << ICNC3) | (1 << ICES3))
+
+#endif /* PWM_16BIT */
+
+/* PRIVATE VARIABLES *********************************************************/
+
+#ifdef PWM_16BIT
+
+static volatile uint16_t top = PWM_DEFAULT_TOP;
+static volatile uint16_t pendingTop;
+static volatile uint16_t pendingDuty;
+static volatile bool pending = false;
+
+static uint8_t timerMode = PWM_MODE_FAST;
+
+/*
+ * timebase for the input capture: ticks of PWM_TIMEBASE_CYCLES plus the
+ * timer clocks left over, advanced by one PWM period per overflow.
+ * bufferedTop is the TOP last written to OCR3A, timebaseTop the one of the
+ * running period (OCR3A is latched at BOTTOM).
+ */
+static volatile uint32_t timebaseTicks = 0;
+static volatile uint8_t timebaseRemainder = 0;
+static volatile uint16_t timebaseTop = PWM_DEFAULT_TOP;
+static uint16_t bufferedTop = PWM_DEFAULT_TOP;
+static uint8_t timebaseShift = 6;
+static volatile bool captureEnabled = false;
+
+#endif /* PWM_16BIT */
+
+static volatile bool rampActive = false;
+static uint32_t rampPosition;
+static uint32_t rampIncrement;
+static uint16_t rampStart;
+static uint16_t rampSpan;
+static uint16_t rampTarget;
+static bool rampDown;
+static uint8_t rampProfile;
+
+volatile pPwmRampCallback myPwmRampCallback = NULL;
+
+static void pwm_rampDone(void* param);
+
+/* one-shot task that calls the ramp callback */
+static taskDescriptor rampDoneTask = { .task = &pwm_rampDone, .param = NULL,
+		.expire = 0, .period = 0 };
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+/*
+ * current duty cycle in the units of the active timer, written by the ramp
+ */
+#ifndef PWM_16BIT
+
+static inline uint16_t pwm_readDuty(void) {
+	return OCR0B;
+}
+
+static inline uint16_t pwm_maxDuty(void) {
+	return 0xFF;
+}
+
+static inline void pwm_writeDuty(uint16_t dutyCycle) {
+	OCR0B = (uint8_t) dutyCycle;
+}
+
+#else
+
+static inline uint16_t pwm_readDuty(void) {
+	return pending ? pendingDuty : TIMER3_COMPARE_REGISTER;
+}
+
+static inline uint16_t pwm_maxDuty(void) {
+	return pending ? pendingTop : top;
+}
+
+/* only called with interrupts disabled */
+static inline void pwm_writeDuty(uint16_t dutyCycle) {
+
+	if (pending) {
+		pendingDuty = dutyCycle;
+	} else {
+		TIMER3_COMPARE_REGISTER = dutyCycle;
+	}
+}
+
+#endif /* PWM_16BIT */
+
+/*
+ * computes the next duty cycle of the ramp, called with interrupts disabled
+ *
+ * @return true, if the ramp reached its target
+ */
+static inline bool pwm_rampUpdate(void) {
+
+	uint16_t progress;
+	uint16_t offset;
+
+	rampPosition += rampIncrement;
+	if (rampPosition >= RAMP_END) {
+		pwm_writeDuty(rampTarget);
+		return true;
+	}
+
+	progress = (uint16_t) (rampPosition
+			>> (RAMP_POSITION_BITS - RAMP_PROFILE_BITS));
+
+	if (rampProfile == PWM_RAMP_S_CURVE) {
+		/*
+		 * smoothstep p^2 * (3 - 2p) with p in Q15, the product stays
+		 * below 2^32
+		 */
+		uint32_t square = ((uint32_t) progress * progress) >> RAMP_PROFILE_BITS;
+		progress = (uint16_t) ((square
+				* ((3UL << RAMP_PROFILE_BITS) - 2UL * progress))
+				>> RAMP_PROFILE_BITS);
+	}
+
+	offset = (uint16_t) (((uint32_t) rampSpan * progress) >> RAMP_PROFILE_BITS);
+	pwm_writeDuty(rampDown ? rampStart - offset : rampStart + offset);
+	return false;
+}
+
+/*
+ * scheduler tick callback while a ramp is active, runs every RAMP_PERIOD_MS
+ * in the timer 2 interrupt
+ */
+static void pwm_rampTick(void* param) {
+
+	if (rampActive && pwm_rampUpdate()) {
+		rampActive = false;
+		scheduler_setTickCallback(NULL);
+
+		if (myPwmRampCallback != NULL) {
+			scheduler_add(&rampDoneTask);
+		}
+	}
+}
+
+/*
+ * calls the ramp callback in task context
+ */
+static void pwm_rampDone(void* param) {
+
+	pPwmRampCallback callback = myPwmRampCallback;
+
+	if (callback != NULL) {
+		callback();
+	}
+}
 
 /*-----------------------------------------------------------
  * Implementation of functions defined in scheduler.h *
  *----------------------------------------------------------*/
 
+#ifndef PWM_16BIT
+
 void pwm_init(void) {
 
 	DDR_REGISTER(PORTG) |= (1 << PG5);    //set the pin as O/P
@@ -32,3 +227,269 @@ void pwm_setDutyCycle(uint8_t dutyCycle) {
 
 	OCR0B = dutyCycle;
 }
+
+#else
+
+/*
+ * timer clocks of one PWM period
+ */
+static inline uint32_t pwm_periodClocks(uint16_t periodTop) {
+
+	return (timerMode == PWM_MODE_PHASE_CORRECT) ?
+			2UL * periodTop : periodTop + 1UL;
+}
+
+/*
+ * a stale flag would run the ISR in the middle of a period, the staged
+ * values have to be written right after the update. While the interrupt
+ * is enabled the flag is not stale, it holds a period the timebase still
+ * has to count.
+ */
+static inline void pwm_enableOverflow(void) {
+
+	if (!(TIMER_INTERRUPT_MASK_3 & (1 << TOIE3))) {
+		TIMER_INTERRUPT_FLAG_REGISTER3 = (1 << TOV3);
+		TIMER_INTERRUPT_MASK_3 |= (1 << TOIE3);
+	}
+}
+
+void pwm_init(void) {
+
+	pwm_init16(PWM_MODE_FAST, PWM_PRESCALER_1, PWM_DEFAULT_TOP);
+}
+
+void pwm_setDutyCycle(uint8_t dutyCycle) {
+
+	uint16_t currentTop = pwm_getTop();
+
+	/*
+	 * 255 is the full period like on timer 0, the other values are scaled
+	 * by (TOP + 1) / 256 with a multiply and a shift
+	 */
+	if (dutyCycle == 0xFF) {
+		pwm_setDutyCycle16(currentTop);
+	} else {
+		pwm_setDutyCycle16(
+				(uint16_t) (((uint32_t) dutyCycle * (currentTop + 1UL)) >> 8));
+	}
+}
+
+void pwm_init16(uint8_t mode, uint8_t prescaler, uint16_t newTop) {
+
+	if (newTop < PWM_MIN_TOP) {
+		newTop = PWM_MIN_TOP;
+	}
+
+	DDR_REGISTER(PWM_OUTPUT_PORT) |= (1 << PWM_OUTPUT_PIN);
+
+	POWER_REDUCTION_REGISTER_1 &= ~(1 << PRTIM3);
+
+	pwm_rampStop();
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		uint8_t captureBits = TIMER3_CONTROL_REGISTER_3B & CAPTURE_CONTROL_BITS;
+
+		/*
+		 * the part of the period that already ran goes into the timebase,
+		 * the counter restarts at 0 with the new prescaler
+		 */
+		TIMER3_CONTROL_REGISTER_3B = captureBits;
+		timebaseTicks = pwm_extendTime(TIMER3_REGISTER);
+		timebaseRemainder = 0;
+
+		timerMode = mode;
+		timebaseShift = (prescaler == PWM_PRESCALER_64) ? 0 :
+						(prescaler == PWM_PRESCALER_8) ? 3 : 6;
+		TIMER_INTERRUPT_FLAG_REGISTER3 = (1 << TOV3);
+
+		TIMER3_REGISTER = 0;
+		TIMER3_TOP_REGISTER = newTop;
+		TIMER3_COMPARE_REGISTER = 0;
+		top = newTop;
+		bufferedTop = newTop;
+		timebaseTop = newTop;
+		pending = false;
+
+		/*
+		 * Set OC3B on compare match, clear at BOTTOM (inverting mode), the
+		 * same polarity as timer 0. TOP is OCR3A in both modes, ICR3 stays
+		 * free for the input capture: mode 15 fast PWM, or mode 9 phase
+		 * and frequency correct PWM, which latches TOP and compare value
+		 * together at BOTTOM and keeps the output symmetric when TOP
+		 * changes. Mode 14 would use ICR3 as TOP and lose the capture.
+		 */
+		if (mode == PWM_MODE_PHASE_CORRECT) {
+			TIMER3_CONTROL_REGISTER_3A = (1 << COM3B1) | (1 << COM3B0)
+					| (1 << WGM30);
+			TIMER3_CONTROL_REGISTER_3B = captureBits | (1 << WGM33)
+					| (prescaler & 0x07);
+		} else {
+			TIMER3_CONTROL_REGISTER_3A = (1 << COM3B1) | (1 << COM3B0)
+					| (1 << WGM31) | (1 << WGM30);
+			TIMER3_CONTROL_REGISTER_3B = captureBits | (1 << WGM33)
+					| (1 << WGM32) | (prescaler & 0x07);
+		}
+
+		if (captureEnabled) {
+			TIMER_INTERRUPT_MASK_3 |= (1 << TOIE3);
+		} else {
+			TIMER_INTERRUPT_MASK_3 &= ~(1 << TOIE3);
+		}
+	}
+}
+
+void pwm_setDutyCycle16(uint16_t dutyCycle) {
+
+	/*
+	 * 16 bit registers are written through the shared TEMP register,
+	 * an ISR in between could corrupt the high byte
+	 */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (pending) {
+			pendingDuty = (dutyCycle > pendingTop) ? pendingTop : dutyCycle;
+		} else {
+			TIMER3_COMPARE_REGISTER = (dutyCycle > top) ? top : dutyCycle;
+		}
+	}
+}
+
+void pwm_setTop(uint16_t newTop, uint16_t dutyCycle) {
+
+	if (newTop < PWM_MIN_TOP) {
+		newTop = PWM_MIN_TOP;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		pendingTop = newTop;
+		pendingDuty = (dutyCycle > newTop) ? newTop : dutyCycle;
+		pending = true;
+		pwm_enableOverflow();
+	}
+}
+
+uint16_t pwm_getTop(void) {
+
+	uint16_t value;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = pending ? pendingTop : top;
+	}
+	return value;
+}
+
+void pwm_enableCapture(void) {
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		TIMER3_CONTROL_REGISTER_3B |= CAPTURE_CONTROL_BITS;
+		captureEnabled = true;
+		pwm_enableOverflow();
+	}
+}
+
+uint32_t pwm_extendTime(uint16_t count) {
+
+	uint32_t clocks = (uint32_t) timebaseRemainder + count;
+
+	/*
+	 * if the overflow is pending, the value was taken either just before
+	 * it (high value) or after it (low value, timebase not advanced yet)
+	 */
+	if ((TIMER_INTERRUPT_FLAG_REGISTER3 & (1 << TOV3))
+			&& count < (timebaseTop >> 1)) {
+		clocks += pwm_periodClocks(timebaseTop);
+	}
+	return timebaseTicks + (clocks >> timebaseShift);
+}
+
+/*
+ * TOV3 is set right after the buffers were latched (TOP in fast mode,
+ * BOTTOM in phase correct mode), a whole period is left to write both
+ */
+ISR(TIMER3_OVF_vect) {
+
+	/*
+	 * the period that just ended goes into the timebase. The TOP of the
+	 * next one was latched from the buffer at BOTTOM, before a staged TOP
+	 * is written below.
+	 */
+	uint32_t clocks = timebaseRemainder + pwm_periodClocks(timebaseTop);
+
+	timebaseTicks += clocks >> timebaseShift;
+	timebaseRemainder = (uint8_t) clocks & ((1 << timebaseShift) - 1);
+	timebaseTop = bufferedTop;
+
+	if (pending) {
+		TIMER3_TOP_REGISTER = pendingTop;
+		TIMER3_COMPARE_REGISTER = pendingDuty;
+		top = pendingTop;
+		bufferedTop = pendingTop;
+		pending = false;
+	}
+
+	/* without the capture the interrupt only served the staged TOP */
+	if (!captureEnabled) {
+		TIMER_INTERRUPT_MASK_3 &= ~(1 << TOIE3);
+	}
+}
+
+#endif /* PWM_16BIT */
+
+/*
+ * ramp control, shared by both timers
+ */
+
+void pwm_rampStart(uint16_t target, uint16_t durationMs, uint8_t profile) {
+
+	uint16_t updates = durationMs / RAMP_PERIOD_MS;
+
+	if (updates == 0) {
+		updates = 1;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		uint16_t current = pwm_readDuty();
+
+		if (target > pwm_maxDuty()) {
+			target = pwm_maxDuty();
+		}
+
+		rampStart = current;
+		rampTarget = target;
+		rampDown = (target < current);
+		rampSpan = rampDown ? current - target : target - current;
+		rampIncrement = (RAMP_END + updates - 1) / updates;
+		rampPosition = 0;
+		rampProfile = profile;
+
+		/* a running ramp keeps its tick, only the state is replaced */
+		if (!rampActive) {
+			rampActive = true;
+			scheduler_setTickCallback(&pwm_rampTick);
+		}
+	}
+}
+
+void pwm_rampStop(void) {
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (rampActive) {
+			rampActive = false;
+			scheduler_setTickCallback(NULL);
+		}
+	}
+}
+
+bool pwm_rampIsDone(void) {
+	return !rampActive;
+}
+
+void pwm_setRampCallback(pPwmRampCallback cb) {
+	myPwmRampCallback = cb;
+}
@@ -11,11 +11,149 @@
 /*INCLUDES *******************************************************************/
 #include "ses_common.h"
 
+/* DEFINES & MACROS **********************************************************/
+
+/*
+ * Define PWM_16BIT to drive the motor from the 16 bit timer 3 instead of the
+ * 8 bit timer 0. The output is OC3B (PE4), so the motor transistor has to be
+ * connected there instead of PG5. Timer 3 is also the timebase of ses_tacho:
+ * with PWM_16BIT ses_pwm owns the timer configuration, the input capture
+ * unit keeps working next to the PWM output and ses_tacho extends its
+ * captures with pwm_extendTime.
+ */
+#ifdef PWM_16BIT
+
+/* default resolution: TOP 1023 gives 10 bit at 15.6 kHz (fast mode) */
+#define PWM_DEFAULT_TOP                 1023
+
+/* one tick of the timebase of pwm_extendTime is 64 CPU cycles (4 us) */
+#define PWM_TIMEBASE_CYCLES             64
+
+enum PwmModes {
+	PWM_MODE_FAST = 0,      ///< single slope, f = F_CPU / (prescaler * (TOP + 1))
+	PWM_MODE_PHASE_CORRECT  ///< dual slope, f = F_CPU / (2 * prescaler * TOP)
+};
+
+enum PwmPrescalers {
+	PWM_PRESCALER_1 = 1,    ///< values are the clock select bits of the timer
+	PWM_PRESCALER_8 = 2,
+	PWM_PRESCALER_64 = 3
+};
+
+#endif /* PWM_16BIT */
+
+/* TYPES ********************************************************************/
+
+enum PwmRampProfiles {
+	PWM_RAMP_LINEAR = 0,    ///< constant slope
+	PWM_RAMP_S_CURVE        ///< smoothstep 3p^2 - 2p^3, zero slope at both ends
+};
+
+/**type of function pointer called in task context when a ramp is done
+ */
+typedef void (*pPwmRampCallback)(void);
+
 /*PROTOTYPES *****************************************************************/
 
+/**
+ * Starts the PWM. With PWM_16BIT this is pwm_init16(PWM_MODE_FAST,
+ * PWM_PRESCALER_1, PWM_DEFAULT_TOP).
+ */
 void pwm_init(void);
 
+/**
+ * Sets the duty cycle with 8 bit resolution, 255 is the full period.
+ * With PWM_16BIT the value is scaled to the current TOP.
+ */
 void pwm_setDutyCycle(uint8_t dutyCycle);
 
+/**
+ * Moves the duty cycle to a target along a profile. The duty cycle is
+ * updated once per ms in the timer 2 interrupt through the scheduler tick
+ * callback, so scheduler_init has to be called before and no other module
+ * may use that callback. A running ramp is replaced. pwm_setDutyCycle does
+ * not stop a ramp, use pwm_rampStop first.
+ *
+ * @param target      final duty cycle, 0 to 255 (0 to TOP with PWM_16BIT)
+ * @param durationMs  ramp time in ms, 0 sets the target at the next update
+ * @param profile     element of the PwmRampProfiles enum
+ */
+void pwm_rampStart(uint16_t target, uint16_t durationMs, uint8_t profile);
+
+/**
+ * Stops a running ramp, the duty cycle stays where it is.
+ */
+void pwm_rampStop(void);
+
+/**
+ * @return true, if no ramp is running
+ */
+bool pwm_rampIsDone(void);
+
+/**
+ * Sets a function to be called in task context when a ramp reached its
+ * target.
+ *
+ * @param cb  pointer to the callback function; if NULL, no callback
+ *            will be executed.
+ */
+void pwm_setRampCallback(pPwmRampCallback cb);
+
+#ifdef PWM_16BIT
+
+/**
+ * Starts timer 3 as 16 bit PWM on OC3B (PE4), with TOP in OCR3A.
+ *
+ * @param mode       element of the PwmModes enum
+ * @param prescaler  element of the PwmPrescalers enum
+ * @param top        resolution of the duty cycle, at least 3
+ */
+void pwm_init16(uint8_t mode, uint8_t prescaler, uint16_t top);
+
+/**
+ * Sets the duty cycle with full resolution. The compare register is
+ * double buffered by the timer and latched at TOP, so the current period
+ * always completes with the old value.
+ *
+ * @param dutyCycle  0 to TOP, larger values are limited to TOP
+ */
+void pwm_setDutyCycle16(uint16_t dutyCycle);
+
+/**
+ * Changes frequency and resolution without a glitch. TOP and duty cycle
+ * are staged and written together right after the next TOP/BOTTOM, so
+ * both are latched in the same period.
+ *
+ * @param top        new TOP, at least 3
+ * @param dutyCycle  duty cycle for the new TOP
+ */
+void pwm_setTop(uint16_t top, uint16_t dutyCycle);
+
+/**
+ * Current TOP, the staged one if a change is pending.
+ */
+uint16_t pwm_getTop(void);
+
+/**
+ * Sets up the input capture unit of timer 3 for ses_tacho: noise canceler
+ * and rising edges on ICP3 (PE7). The overflow interrupt then runs every
+ * PWM period to extend the timebase, about 40 cycles per period.
+ * Needs PWM_MODE_FAST, the counter of the phase correct mode runs up and
+ * down and a capture value does not tell on which slope it was taken.
+ */
+void pwm_enableCapture(void);
+
+/**
+ * Extends a value of timer 3 (TCNT3 or ICR3) to a 32 bit timebase with
+ * PWM_TIMEBASE_CYCLES per tick that does not depend on TOP and prescaler.
+ * Call with interrupts disabled, right after the value was read and at
+ * most half a PWM period after it was latched.
+ *
+ * @param count  timer value from the current or the just finished period
+ * @return time in ticks
+ */
+uint32_t pwm_extendTime(uint16_t count);
+
+#endif /* PWM_16BIT */
 
 #endif /* SES_PWM_H_ */
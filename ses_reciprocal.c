@@ -0,0 +1,109 @@
+/*
+ ***************************************************************************
+ ses_reciprocal V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_reciprocal replaces the 32 bit software division (several hundred
+ cycles on the AVR) by a table seed, one Newton step and a few hardware
+ multiplications. It is used for the period to frequency conversion of the
+ motor.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_reciprocal.h"
+#include <avr/pgmspace.h>
+
+/* DEFINES & MACROS **********************************************************/
+
+/* the normalized divisor x has 16 bits, the reciprocal r = 2^31 / x is Q15 */
+#define RECIPROCAL_TABLE_SHIFT     9
+#define RECIPROCAL_TABLE_MASK      0x3F
+
+/* PRIVATE VARIABLES *********************************************************/
+
+/*
+ * seed 2^31 / x for x in [0x8000 + 512 i, 0x8000 + 512 (i + 1)), taken at
+ * the harmonic mean of the interval so the seed error is at most 2^-8
+ */
+static const uint16_t reciprocalTable[64] PROGMEM = {
+		0xFE08, 0xFA27, 0xF664, 0xF2BD, 0xEF32, 0xEBC1, 0xE869, 0xE528,
+		0xE1FF, 0xDEEC, 0xDBEE, 0xD904, 0xD62E, 0xD36A, 0xD0B9, 0xCE19,
+		0xCB89, 0xC90A, 0xC69A, 0xC439, 0xC1E6, 0xBFA2, 0xBD6B, 0xBB40,
+		0xB923, 0xB711, 0xB50B, 0xB311, 0xB121, 0xAF3C, 0xAD61, 0xAB91,
+		0xA9C9, 0xA80C, 0xA657, 0xA4AB, 0xA307, 0xA16C, 0x9FD9, 0x9E4E,
+		0x9CCA, 0x9B4D, 0x99D8, 0x986A, 0x9702, 0x95A1, 0x9446, 0x92F2,
+		0x91A3, 0x905B, 0x8F18, 0x8DDB, 0x8CA3, 0x8B71, 0x8A44, 0x891B,
+		0x87F8, 0x86DA, 0x85C0, 0x84AB, 0x839A, 0x828D, 0x8185, 0x8081 };
+
+/* FUNCTION DEFINITION *******************************************************/
+
+uint16_t reciprocal_divide(uint16_t numerator, uint32_t denominator) {
+
+	return (uint16_t) reciprocal_divideScaled(numerator, denominator, 0);
+}
+
+uint32_t reciprocal_divideScaled(uint16_t numerator, uint32_t denominator,
+		uint8_t scale) {
+
+	uint8_t shift = 0;
+	uint16_t x;
+	uint32_t r;
+	uint32_t product;
+	uint8_t resultShift;
+
+	if (denominator == 0) {
+		return 0xFFFF;
+	}
+
+	/*
+	 * normalize so that the MSB is set, whole bytes first
+	 */
+	while (!(denominator & 0xFF000000UL)) {
+		denominator <<= 8;
+		shift += 8;
+	}
+	while (!(denominator & 0x80000000UL)) {
+		denominator <<= 1;
+		shift++;
+	}
+
+	/*
+	 * x = denominator / 2^16 in [2^15, 2^16), the truncated lower bits
+	 * cost less than 2^-15 of relative accuracy
+	 */
+	x = denominator >> 16;
+
+	/*
+	 * Newton step r1 = r0 * (2 - x * r0) in Q15, only 16x16 bit products
+	 */
+	r = pgm_read_word(&reciprocalTable[(x >> RECIPROCAL_TABLE_SHIFT)
+			& RECIPROCAL_TABLE_MASK]);
+	uint16_t error = ((uint32_t) x * (uint16_t) r) >> 16;
+	r = ((uint32_t) (uint16_t) r * (uint16_t) (0x10000UL - error)) >> 15;
+
+	/*
+	 * numerator * 2^scale / denominator = numerator * r * 2^(shift + scale - 47)
+	 */
+	product = (uint32_t) numerator * (uint16_t) (r > 0xFFFF ? 0xFFFF : r);
+	resultShift = 47 - shift - scale;
+
+	if (resultShift > 32) {
+		return 0;
+	}
+
+	if (resultShift > 16) {
+		/*
+		 * the upper half is taken by a byte move, the remaining shift
+		 * runs on 16 bit only
+		 */
+		uint16_t q = product >> 16;
+		q >>= (resultShift - 17);
+		return (q + 1) >> 1;
+	}
+
+	return ((product >> (resultShift - 1)) + 1) >> 1;
+}
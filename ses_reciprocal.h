@@ -0,0 +1,40 @@
+#ifndef SES_RECIPROCAL_H_
+#define SES_RECIPROCAL_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include "ses_common.h"
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Divides without a software division: the denominator is normalized, a
+ * reciprocal seed is taken from a 64 entry PROGMEM table and refined with
+ * one Newton step in 16 bit fixed point, then multiplied by the numerator.
+ *
+ * Accuracy for all 32 bit denominators, checked on the host against the
+ * exact quotient: the relative error is below 1e-4 (seed 2^-8, squared by
+ * the Newton step, plus the 16 bit truncation), on top of the rounding to
+ * an integer. The result is within 1 of the rounded quotient for results
+ * below 10000 and within 4 for the largest result 65535 / 1.
+ *
+ * @param numerator    dividend
+ * @param denominator  divisor, 0 returns 0xFFFF
+ * @return             numerator / denominator, rounded
+ */
+uint16_t reciprocal_divide(uint16_t numerator, uint32_t denominator);
+
+/**
+ * Like reciprocal_divide, but the numerator is scaled by 2^scale first, so
+ * quotients with numerators above 16 bit keep their full precision.
+ *
+ * @param numerator    dividend before scaling
+ * @param denominator  divisor, 0 returns 0xFFFF
+ * @param scale        left shift of the numerator, at most 15
+ * @return             numerator * 2^scale / denominator, rounded
+ */
+uint32_t reciprocal_divideScaled(uint16_t numerator, uint32_t denominator,
+		uint8_t scale);
+
+#endif /* SES_RECIPROCAL_H_ */
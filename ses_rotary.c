@@ -15,33 +15,108 @@
 #include <stdbool.h>
 
 #include "ses_rotary.h"
+#include "util/atomic.h"
+#include "ses_input.h"
+#include "ses_gpio.h"
 
 /*-----------------------------------------------------------
  * Implementation of functions defined in scheduler.h *
  *----------------------------------------------------------*/
 
-#define ROTARY_BIN_1            5
-#define ROTARY_BIN_2            2
-#define BUTTON_NUM_DEBOUNCE_CHECKS  5
+#define ROTARY_BIN_1            INPUT_ROTARY_A_PIN
+#define ROTARY_BIN_2            INPUT_ROTARY_B_PIN
+#define ROTARY_A                INPUT_ROTARY_A_PORT, ROTARY_BIN_1
+#define ROTARY_B                INPUT_ROTARY_B_PORT, ROTARY_BIN_2
+
+/*
+ * the decoder runs on every input sampler tick (500 us), fast enough for
+ * 2000 transitions (500 detents) per second
+ */
+#define ROTARY_SAMPLE_PERIOD_US INPUT_SAMPLE_PERIOD_US
+
+/* marks a transition where both channels changed at once */
+#define QUADRATURE_ILLEGAL      2
+
+/*
+ * step intervals are measured in samples and saturate after 100 ms,
+ * a longer pause counts as standstill and restarts the estimate
+ */
+#define ROTARY_IDLE_SAMPLES     200
+
+/* fraction bits of the smoothed interval and of the acceleration gain */
+#define INTERVAL_FRACTION_BITS  4
+#define GAIN_FRACTION_BITS      4
+#define GAIN_ONE                (1 << GAIN_FRACTION_BITS)
+
+/* the smoothed interval moves 1/4 of the way to every new interval */
+#define INTERVAL_SMOOTHING      2
 
 /* PRIVATE VARIABLES **************************************************/
 
 pTypeRotaryCallback CWcallback = NULL;
 pTypeRotaryCallback CCWcallback = NULL;
 
-uint8_t CW = 0;
-uint8_t CCW = 0;
+/*
+ * step for each transition, indexed by (last inputs << 2) | inputs with
+ * inputs = (BIN_1 << 1) | BIN_2. Clockwise follows the Gray code sequence
+ * 00 -> 10 -> 11 -> 01 -> 00, i.e. BIN_1 leads BIN_2.
+ */
+static const int8_t quadratureTable[16] = {
+		0, -1, 1, QUADRATURE_ILLEGAL,
+		1, 0, QUADRATURE_ILLEGAL, -1,
+		-1, QUADRATURE_ILLEGAL, 0, 1,
+		QUADRATURE_ILLEGAL, 1, -1, 0 };
+
+static uint8_t lastInputs = 0; /* channel levels of the last sample */
+static volatile int16_t position = 0; /* accumulated transitions, CW positive */
+static volatile uint16_t errorCount = 0; /* illegal transitions seen */
+static int16_t consumedPosition = 0; /* position already reported as detents */
+
+static uint8_t samplesSinceStep = ROTARY_IDLE_SAMPLES; /* samples since the last valid transition */
+static int8_t lastStep = 0; /* direction of the last valid transition */
+static volatile uint16_t smoothedInterval = ROTARY_IDLE_SAMPLES << INTERVAL_FRACTION_BITS; /* in samples, Q4 */
+static volatile bool intervalValid = false; /* smoothedInterval holds a measured interval */
+
+/* acceleration curve converted to samples, the default is a plain 1:1 */
+static uint16_t accelLimits[ROTARY_ACCEL_MAX_POINTS]; /* in samples, Q4 */
+static uint8_t accelGains[ROTARY_ACCEL_MAX_POINTS];
+static uint8_t accelPoints = 0;
+static int16_t accelRemainder = 0; /* fraction of a step not delivered yet, Q4 */
+
+static void rotary_decode(uint8_t snapshot);
+
+/*FUNCTION DEFINITION *************************************************/
+
+/*
+ * (BIN_1 << 1) | BIN_2 taken from one input snapshot
+ */
+static inline uint8_t rotary_inputs(uint8_t snapshot) {
+
+	return (snapshot >> INPUT_ROTARY_B) & 3;
+}
 
 void rotary_init() {
 
-	DDR_REGISTER(PORTB) &= ~(1 << ROTARY_BIN_1);
+	GPIO_MAKE_INPUT(ROTARY_A);
 
-	PORTB |= (1 << ROTARY_BIN_1);
+	GPIO_SET(ROTARY_A);
 
-	DDR_REGISTER(PORTG) &= ~(1 << ROTARY_BIN_2);
+	GPIO_MAKE_INPUT(ROTARY_B);
 
-	PORTB |= (1 << ROTARY_BIN_2);
+	GPIO_SET(ROTARY_B);
 
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		lastInputs = rotary_inputs(input_getSnapshot());
+		position = 0;
+		errorCount = 0;
+		consumedPosition = 0;
+		samplesSinceStep = ROTARY_IDLE_SAMPLES;
+		smoothedInterval = ROTARY_IDLE_SAMPLES << INTERVAL_FRACTION_BITS;
+		intervalValid = false;
+	}
+
+	input_startSampler(&rotary_decode);
 }
 
 void rotary_setClockwiseCallback(pTypeRotaryCallback callback) {
@@ -53,7 +128,7 @@ void rotary_setCounterClockwiseCallback(pTypeRotaryCallback callback) {
 }
 
 bool bin1_state() {
-	if ((PIN_REGISTER(PORTB) & (1 << ROTARY_BIN_1)) == 0) {
+	if ((input_getSnapshot() & (1 << INPUT_ROTARY_A)) == 0) {
 		return true;
 	}
 
@@ -64,7 +139,7 @@ bool bin1_state() {
 }
 
 bool bin2_state() {
-	if ((PIN_REGISTER(PORTG) & (1 << ROTARY_BIN_2)) == 0) {
+	if ((input_getSnapshot() & (1 << INPUT_ROTARY_B)) == 0) {
 		return true;
 	}
 
@@ -74,57 +149,202 @@ bool bin2_state() {
 
 }
 
-void rotary_checkState(void* checkP) {
+int16_t rotary_getPosition(void) {
 
-	static uint8_t state[BUTTON_NUM_DEBOUNCE_CHECKS] = { };
-	static uint8_t index = 0;
-	static uint8_t debouncedState = 0;
-	uint8_t lastDebouncedState = debouncedState;
+	int16_t value;
 
-	/* each bit in every state byte represents one button*/
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = position;
+	}
+	return value;
+}
+
+uint16_t rotary_getErrorCount(void) {
 
-	state[index] = 0;
+	uint16_t value;
 
-	/*This indicates that there is a change in BIN_1
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = errorCount;
+	}
+	return value;
+}
+
+int8_t rotary_getDelta(void) {
+
+	int16_t delta = rotary_getPosition() - consumedPosition;
+
+	/*
+	 * only whole detents are reported, the remaining transitions
+	 * stay for the next call. Signed division by a power of two
+	 * rounds towards zero, so both directions keep their remainder.
 	 */
+	delta /= ROTARY_STEPS_PER_DETENT;
 
-	if (bin1_state()) {
-		state[index] |= 1;
+	if (delta > INT8_MAX) {
+		delta = INT8_MAX;
+	} else if (delta < INT8_MIN) {
+		delta = INT8_MIN;
 	}
 
-	else {
-		state[index] |= 2;
+	consumedPosition += delta * ROTARY_STEPS_PER_DETENT;
+
+	return (int8_t) delta;
+}
+
+uint16_t rotary_getStepInterval(void) {
+
+	uint16_t interval;
+	uint32_t intervalUs;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		interval = smoothedInterval;
+		if (samplesSinceStep >= ROTARY_IDLE_SAMPLES || !intervalValid) {
+			interval = 0;
+		}
+	}
 
+	/*
+	 * Q4 samples to us, intervals above 65 ms saturate
+	 */
+	intervalUs = ((uint32_t) interval * ROTARY_SAMPLE_PERIOD_US)
+			>> INTERVAL_FRACTION_BITS;
+	if (intervalUs > UINT16_MAX) {
+		intervalUs = UINT16_MAX;
 	}
+	return (uint16_t) intervalUs;
+}
+
+uint16_t rotary_getVelocity(void) {
 
-	index++;
-	if (index == BUTTON_NUM_DEBOUNCE_CHECKS) {
-		index = 0;
+	uint16_t interval = rotary_getStepInterval();
+
+	if (interval == 0) {
+		return 0;
 	}
+	return (uint16_t) (1000000UL / interval);
+}
+
+void rotary_setAccelerationCurve(const rotaryAccelPoint_t* curve, uint8_t n) {
 
-	uint8_t j = 0xFF;
-	for (uint8_t i = 0; i < BUTTON_NUM_DEBOUNCE_CHECKS; i++) {
-		j = j & state[i];
+	if (n > ROTARY_ACCEL_MAX_POINTS) {
+		n = ROTARY_ACCEL_MAX_POINTS;
 	}
-	debouncedState = j;
 
-	/*// If the previous and the current state of ROTARY_BIN_1
-	 * are different, that means a Pulse has happened*/
+	/*
+	 * the limits are converted from us to Q4 samples once, so the lookup
+	 * only compares against the smoothed interval
+	 */
+	for (uint8_t i = 0; i < n; i++) {
+		accelLimits[i] = (uint16_t) (((uint32_t) curve[i].maxIntervalUs
+				<< INTERVAL_FRACTION_BITS) / ROTARY_SAMPLE_PERIOD_US);
+		accelGains[i] = curve[i].gain;
+	}
+	accelPoints = n;
+	accelRemainder = 0;
+}
 
-	if (lastDebouncedState != debouncedState) {
+int16_t rotary_getAcceleratedDelta(void) {
 
-		if (bin1_state() != bin2_state()) {
-			CWcallback();
-		}
+	int8_t delta = rotary_getDelta();
+	uint8_t gain = GAIN_ONE;
+	uint16_t interval;
 
-		else {
+	if (delta == 0) {
+		return 0;
+	}
 
-			CCWcallback();
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		interval = smoothedInterval;
+	}
+
+	/*
+	 * the first point whose limit the interval does not exceed wins,
+	 * slower than all points means no acceleration
+	 */
+	for (uint8_t i = 0; i < accelPoints; i++) {
+		if (interval <= accelLimits[i]) {
+			gain = accelGains[i];
+			break;
 		}
+	}
 
-		lastDebouncedState = debouncedState;
+	/*
+	 * the fractional part is kept so gains like 1.5 deliver 3 steps
+	 * for every 2 detents
+	 */
+	int16_t scaled = (int16_t) delta * gain + accelRemainder;
+	int16_t steps = scaled / GAIN_ONE;
+	accelRemainder = scaled - steps * GAIN_ONE;
+
+	return steps;
+}
+
+void rotary_checkState(void* checkP) {
 
+	int8_t delta = rotary_getDelta();
+
+	/*
+	 * one callback per detent, the callbacks run in task context
+	 */
+	while (delta > 0) {
+		if (CWcallback != NULL) {
+			CWcallback();
+		}
+		delta--;
 	}
 
+	while (delta < 0) {
+		if (CCWcallback != NULL) {
+			CCWcallback();
+		}
+		delta++;
+	}
 }
 
+/*
+ * called by the input sampler in its timer4 interrupt with the snapshot
+ * of this tick
+ */
+static void rotary_decode(uint8_t snapshot) {
+
+	uint8_t inputs = rotary_inputs(snapshot);
+	int8_t step = quadratureTable[(lastInputs << 2) | inputs];
+
+	lastInputs = inputs;
+
+	if (step == QUADRATURE_ILLEGAL) {
+		errorCount++;
+	} else if (step != 0) {
+		position += step;
+
+		/*
+		 * velocity estimate without division: the interval between two
+		 * transitions is counted in samples and smoothed by a shift.
+		 * After a pause or a reversal the estimate starts over, the
+		 * first measured interval then replaces it at once so it does
+		 * not have to converge from the idle value.
+		 */
+		int16_t interval = (uint16_t) samplesSinceStep << INTERVAL_FRACTION_BITS;
+
+		if (samplesSinceStep >= ROTARY_IDLE_SAMPLES || step != lastStep) {
+			smoothedInterval = ROTARY_IDLE_SAMPLES << INTERVAL_FRACTION_BITS;
+			intervalValid = false;
+		} else if (!intervalValid) {
+			smoothedInterval = interval;
+			intervalValid = true;
+		} else {
+			smoothedInterval += (interval - (int16_t) smoothedInterval)
+					>> INTERVAL_SMOOTHING;
+		}
+		samplesSinceStep = 0;
+		lastStep = step;
+	}
+
+	if (samplesSinceStep < ROTARY_IDLE_SAMPLES) {
+		samplesSinceStep++;
+	}
+}
@@ -10,12 +10,31 @@
 #ifndef SES_ROTARY_H_
 #define SES_ROTARY_H_
 
+/**number of quadrature transitions between two detents of the encoder
+ */
+#ifndef ROTARY_STEPS_PER_DETENT
+#define ROTARY_STEPS_PER_DETENT 4
+#endif
+
+/**maximum number of points of the acceleration curve
+ */
+#define ROTARY_ACCEL_MAX_POINTS 4
+
+/**one point of the acceleration curve: turning faster than maxIntervalUs
+ * between two transitions multiplies the detents by gain / 16
+ */
+typedef struct {
+	uint16_t maxIntervalUs; ///< largest step interval this point applies to
+	uint8_t gain;           ///< fixed-point gain, 16 means 1.0
+} rotaryAccelPoint_t;
+
 /**type of function pointer used as callback
  */
 typedef void (*pTypeRotaryCallback)();
 
 /**
- * Initializes rotary encoder.
+ * Initializes rotary encoder. The quadrature decoder samples both
+ * channels from the timer 4 interrupt.
  */
 
 void rotary_init();
@@ -37,7 +56,8 @@ void rotary_setClockwiseCallback(pTypeRotaryCallback);
 void rotary_setCounterClockwiseCallback(pTypeRotaryCallback);
 
 /**
- * function to determin whether the rotary is rotaed CW or CCW.
+ * Task function: calls the CW or CCW callback once for every detent
+ * turned since the last call.
  *
  * @param void pointer.
  */
@@ -62,4 +82,55 @@ bool bin1_state();
 
 bool bin2_state();
 
+/**
+ * Reads the accumulated position atomically.
+ *
+ * @return transitions since rotary_init, clockwise positive; wraps around
+ */
+int16_t rotary_getPosition(void);
+
+/**
+ * Reads the whole detents turned since the last call atomically.
+ * Transitions that do not form a full detent are kept for the next call.
+ *
+ * @return detents, clockwise positive
+ */
+int8_t rotary_getDelta(void);
+
+/**
+ * Number of illegal transitions (both channels changed between two samples).
+ */
+uint16_t rotary_getErrorCount(void);
+
+/**
+ * Smoothed time between two transitions.
+ *
+ * @return interval in us, saturated at 65535; 0 while the encoder stands
+ *         still or before the second transition after a pause or reversal
+ */
+uint16_t rotary_getStepInterval(void);
+
+/**
+ * Smoothed rotation speed.
+ *
+ * @return transitions per second, 0 while the encoder stands still
+ */
+uint16_t rotary_getVelocity(void);
+
+/**
+ * Sets the acceleration curve used by rotary_getAcceleratedDelta.
+ *
+ * @param curve  points sorted by ascending maxIntervalUs (fastest first)
+ * @param n      number of points, at most ROTARY_ACCEL_MAX_POINTS
+ */
+void rotary_setAccelerationCurve(const rotaryAccelPoint_t* curve, uint8_t n);
+
+/**
+ * Like rotary_getDelta, but the detents are scaled by the gain of the
+ * acceleration curve for the current spin speed.
+ *
+ * @return steps, clockwise positive
+ */
+int16_t rotary_getAcceleratedDelta(void);
+
 #endif /* SES_ROTARY_H_ */
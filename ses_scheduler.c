@@ -27,6 +27,8 @@
 /** list of scheduled tasks head */
 static taskDescriptor* taskList = NULL;
 volatile pTimerCallback myTimerCallback2 = NULL;
+/** called in the timer 2 interrupt on every tick */
+static volatile task_t tickCallback = NULL;
 static systemTime_t time = 0;
 /*FUNCTION DEFINITION *************************************************/
 
@@ -71,6 +73,13 @@ static void scheduler_update(void* m) {
 		listLoopPointer = listLoopPointer->next;
 	}
 
+	/* The tick callback runs last, a task it adds is marked on the
+	 * next tick.
+	 */
+	task_t callback = tickCallback;
+	if (callback != NULL) {
+		callback(NULL);
+	}
 }
 
 void scheduler_init() {
@@ -261,9 +270,11 @@ bool scheduler_add(taskDescriptor * toAdd) {
 			}
 
 			/* Once the last node is found , The
-			 * new toAdd task is added atomically
+			 * new toAdd task is added atomically. A task that was
+			 * removed before still points to its old successor.
 			 */
 
+			toAdd->next = NULL;
 			previousNode->next = toAdd;
 
 		}
@@ -287,124 +298,76 @@ bool scheduler_add(taskDescriptor * toAdd) {
 
 void scheduler_remove(taskDescriptor* toRemove) {
 
-	taskDescriptor* currentNode = taskList;
-	taskDescriptor* previousNode = taskList;
-
-	/* When passing a task to the scheduler_remove function, Its place in
-	 * task list should be determined so that an approperiate remove task is
-	 * performed depending on its position in the list
-	 * There are three cases for adding this toAdd task
-	 */
-
-	/*-------------------------------------------------------------------------
-	 * CASE 1  : Removing The First Node
-	 *-------------------------------------------------------------------------*/
-	/* We loop over the list of tasks to find the last Node (First Empty Node).
-	 Once it is found, we add our task to it and create a new node at the end.
-	 The drawings below is just for demonstration.
-
-
-	 head            Next Node
-	 |               |
-	 |               |
-	 +---+---+  ||   +---+---+
-	 | 1  | o---||-->| # | #----->
-	 +---+---+  ||   +---+---+                    */
-
-	/*If the required task to remove is the task list head, Temporary node
-	 * is created called (nextNode).taskList--points-->nextNode,
-	 * Then the task head is removed from the task and the temperoray
-	 * node(next node) becomes the list head.
-	 */
-
-	if (taskList == toRemove) {
-
-		taskDescriptor* nextNode = taskList->next;
-
-		taskList = NULL;
-		taskList = nextNode;
-		currentNode = taskList;
-		previousNode = taskList;
-
-		return;
-
-	}
-
-	/*-------------------------------------------------------------------------
-	 * CASE 2  : Removing The Last Node
-	 *-------------------------------------------------------------------------*/
-
-	/*If the required task to remove is the last task, The
-	 * The previousNode->next is set to NULL and then
-	 * the current node is freed.
-
-	 Previous Node               Last Node
-	 |                          |
-	 |                          |
-	 +---+---+                  +----+----+
-	 | 2 | o-----> (NULL)       |  # |  # |
-	 +---+---+                  +----+----+
-
-	 */
-
-	else if (currentNode->next == NULL)
-
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
+		taskDescriptor* currentNode = taskList;
+		taskDescriptor* previousNode = NULL;
 
-		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-		{
-			previousNode->next = NULL;
-			currentNode = NULL;
-		}
-		return;
+		/* We loop over the whole list, the last node included, to find
+		 * the task to remove. A task that is not in the list (or NULL)
+		 * is ignored.
+		 */
 
-	}
+		while (currentNode != NULL) {
 
-	/*-------------------------------------------------------------------------
-	 * CASE 3 : Removing Intermediate Node from the Task List
-	 *-------------------------------------------------------------------------*/
-	/* We loop over the list of tasks to find the required task to remove.
-	 Once it is found, We set our previous node to pint to the next one, then.
-	 we freed the intermediate current one.
+			if (currentNode == toRemove) {
 
+				/*-------------------------------------------------------------
+				 * CASE 1  : Removing The First Node
+				 *-------------------------------------------------------------*/
+				/* The next node becomes the list head.
 
-	 head          second         third
-	 |              |             |
-	 |              |             |
-	 +---+---+      +---+---+     +----+----+
-	 | 1  | o-----> | 2 | o--||-  | 3  |  0 |
-	 +---+---+  |   +---+---+     +----+----+
-	 |                  ^
-	 |------>>>---------|
+				 head            Next Node
+				 |               |
+				 |               |
+				 +---+---+  ||   +---+---+
+				 | 1  | o---||-->| # | #----->
+				 +---+---+  ||   +---+---+                    */
 
-	 */
+				if (previousNode == NULL) {
+					taskList = currentNode->next;
+				}
 
-	else {
-		while (currentNode->next != NULL) {
+				/*-------------------------------------------------------------
+				 * CASE 2 : Removing an Intermediate or The Last Node
+				 *-------------------------------------------------------------*/
+				/* The previous node points to the node after the removed
+				 one, which is NULL for the last node.
+
+				 head          second         third
+				 |              |             |
+				 |              |             |
+				 +---+---+      +---+---+     +----+----+
+				 | 1  | o-----> | 2 | o--||-  | 3  |  0 |
+				 +---+---+  |   +---+---+     +----+----+
+				 |                  ^
+				 |------>>>---------|
 
-			if (currentNode == toRemove) {
+				 */
 
-				ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-				{
+				else {
 					previousNode->next = currentNode->next;
-					currentNode = NULL;
-					currentNode = previousNode->next;
 				}
 
+				/* toRemove->next is kept: scheduler_run may stand on the
+				 * removed node and goes on with its successor.
+				 */
 				return;
 			}
 
-			else {
-				/* previous and current nodes are
-				 * updated till the toRemove is found
-				 */
-				previousNode = currentNode;
-				currentNode = currentNode->next;
-			}
+			/* previous and current nodes are
+			 * updated till the toRemove is found
+			 */
+			previousNode = currentNode;
+			currentNode = currentNode->next;
 		}
 	}
 }
 
+void scheduler_setTickCallback(task_t cb) {
+	tickCallback = cb;
+}
+
 systemTime_t scheduler_getTime() {
 	return time;
 }
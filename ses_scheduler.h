@@ -75,6 +75,15 @@ bool scheduler_add(taskDescriptor * td);
  * */
 void scheduler_remove(taskDescriptor * td);
 
+/**
+ * Sets a function called in the timer 2 interrupt on every 1 ms tick,
+ * after the task times are updated. There is one such callback, it has
+ * to be short, e.g. the step of the PWM ramp. NULL removes it.
+ *
+ * @param cb	function to call, its parameter is NULL
+ */
+void scheduler_setTickCallback(task_t cb);
+
 systemTime_t scheduler_getTime();
 
 void scheduler_setTime(systemTime_t time);
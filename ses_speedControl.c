@@ -0,0 +1,187 @@
+/*
+ ***************************************************************************
+ ses_speedControl V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_speedControl is a closed-loop speed controller for the motor. A
+ scheduler task reads the median motor speed and runs a fixed-point PI
+ controller with feed-forward, anti-windup and a rate limit on the duty
+ cycle. The step uses integer arithmetic only (three 16x16 bit products),
+ so its run time does not depend on the operating point.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_speedControl.h"
+#include "ses_scheduler.h"
+#include "ses_motorFrequency.h"
+#include "ses_pwm.h"
+#include "util/atomic.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* the controller state is kept as duty cycle with 8 fraction bits */
+#define DUTY_FRACTION_BITS              8
+#define GAIN_SHIFT                      (SPEEDCONTROL_GAIN_BITS - DUTY_FRACTION_BITS)
+
+#define ERROR_LIMIT                     32767
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static speedControlConfig_t settings;
+
+static volatile uint16_t targetRpm = 0;
+static volatile bool running = false;
+static int32_t integral = 0;   /* Q8 duty */
+static uint8_t duty = 0;
+
+static void speedControl_task(void* param);
+
+static taskDescriptor controlTask = { .task = &speedControl_task, .param =
+NULL, .expire = 0, .period = SPEEDCONTROL_DEFAULT_PERIOD_MS };
+
+static const speedControlConfig_t defaultConfig = { .kp =
+SPEEDCONTROL_DEFAULT_KP, .ki = SPEEDCONTROL_DEFAULT_KI, .kff =
+SPEEDCONTROL_DEFAULT_KFF, .ffOffset = 0, .outMin = 0, .outMax = 255,
+		.maxStep = SPEEDCONTROL_DEFAULT_MAX_STEP, .periodMs =
+		SPEEDCONTROL_DEFAULT_PERIOD_MS };
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static void speedControl_task(void* param) {
+
+	/* a stopped controller never writes the PWM, even if still marked */
+	if (running) {
+		pwm_setDutyCycle(speedControl_step(motorFrequency_getMedianRpm()));
+	}
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+void speedControl_init(const speedControlConfig_t* config) {
+
+	if (config == NULL) {
+		config = &defaultConfig;
+	}
+	settings = *config;
+
+	if (settings.periodMs == 0) {
+		settings.periodMs = SPEEDCONTROL_DEFAULT_PERIOD_MS;
+	}
+	controlTask.period = settings.periodMs;
+
+	integral = 0;
+	duty = 0;
+}
+
+void speedControl_setTarget(uint16_t rpm) {
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		targetRpm = rpm;
+	}
+}
+
+void speedControl_start(void) {
+
+	controlTask.expire = settings.periodMs;
+	running = true;
+	scheduler_add(&controlTask);
+}
+
+void speedControl_stop(void) {
+
+	running = false;
+	scheduler_remove(&controlTask);
+
+	integral = 0;
+	duty = 0;
+	pwm_setDutyCycle(0);
+}
+
+uint8_t speedControl_step(uint16_t measuredRpm) {
+
+	uint16_t target;
+	int32_t error;
+	int32_t output;
+	int32_t limited;
+	int32_t low;
+	int32_t high;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		target = targetRpm;
+	}
+
+	if (target == 0) {
+		integral = 0;
+		duty = 0;
+		return 0;
+	}
+
+	error = (int32_t) target - measuredRpm;
+	if (error > ERROR_LIMIT) {
+		error = ERROR_LIMIT;
+	} else if (error < -ERROR_LIMIT) {
+		error = -ERROR_LIMIT;
+	}
+
+	/*
+	 * feed-forward puts the duty near the operating point at once,
+	 * the PI part only corrects what is left
+	 */
+	output = (((uint32_t) target * settings.kff) >> GAIN_SHIFT)
+			+ ((int32_t) settings.ffOffset << DUTY_FRACTION_BITS);
+	output += ((int32_t) (int16_t) error * settings.kp) >> GAIN_SHIFT;
+	output += integral;
+
+	/* clamp to the output range, then limit the change per period */
+	low = (int32_t) settings.outMin << DUTY_FRACTION_BITS;
+	high = (int32_t) settings.outMax << DUTY_FRACTION_BITS;
+	if (settings.maxStep != 0) {
+		int32_t previous = (int32_t) duty << DUTY_FRACTION_BITS;
+		int32_t step = (int32_t) settings.maxStep << DUTY_FRACTION_BITS;
+
+		if (previous - step > low) {
+			low = previous - step;
+		}
+		if (previous + step < high) {
+			high = previous + step;
+		}
+	}
+
+	limited = output;
+	if (limited > high) {
+		limited = high;
+	} else if (limited < low) {
+		limited = low;
+	}
+
+	/*
+	 * anti-windup: the integrator stops while the output is held by a
+	 * limit in the direction the error pushes it
+	 */
+	if (!((limited < output) && (error > 0))
+			&& !((limited > output) && (error < 0))) {
+		integral += ((int32_t) (int16_t) error * settings.ki) >> GAIN_SHIFT;
+
+		if (integral > ((int32_t) settings.outMax << DUTY_FRACTION_BITS)) {
+			integral = (int32_t) settings.outMax << DUTY_FRACTION_BITS;
+		} else if (integral
+				< -((int32_t) settings.outMax << DUTY_FRACTION_BITS)) {
+			integral = -((int32_t) settings.outMax << DUTY_FRACTION_BITS);
+		}
+	}
+
+	duty = (uint8_t) ((limited + (1 << (DUTY_FRACTION_BITS - 1)))
+			>> DUTY_FRACTION_BITS);
+	return duty;
+}
+
+uint8_t speedControl_getDuty(void) {
+
+	return duty;
+}
@@ -0,0 +1,79 @@
+#ifndef SES_SPEEDCONTROL_H_
+#define SES_SPEEDCONTROL_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ses_common.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/* number of fraction bits of the gains */
+#define SPEEDCONTROL_GAIN_BITS          12
+
+/* default controller settings, checked with test/test_speedControl.c */
+#define SPEEDCONTROL_DEFAULT_PERIOD_MS  20
+#define SPEEDCONTROL_DEFAULT_KP         160  /* ~0.04 duty per rpm */
+#define SPEEDCONTROL_DEFAULT_KI         8    /* ~0.002 duty per rpm and step */
+#define SPEEDCONTROL_DEFAULT_KFF        100  /* ~1/41 duty per rpm */
+#define SPEEDCONTROL_DEFAULT_MAX_STEP   12
+
+/* TYPES ********************************************************************/
+
+/**controller settings, gains are duty per rpm with SPEEDCONTROL_GAIN_BITS
+ * fraction bits
+ */
+typedef struct {
+	uint16_t kp;            ///< proportional gain
+	uint16_t ki;            ///< integral gain, applied once per period
+	uint16_t kff;           ///< feed-forward gain on the target speed
+	uint8_t ffOffset;       ///< feed-forward duty for any target above 0
+	uint8_t outMin;         ///< lowest duty while the target is above 0
+	uint8_t outMax;         ///< highest duty
+	uint8_t maxStep;        ///< max. duty change per period, 0 disables the limit
+	uint16_t periodMs;      ///< control period in ms
+} speedControlConfig_t;
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes the speed controller. pwm_init and motorFrequency_init have
+ * to be called before the controller is started.
+ *
+ * @param config  controller settings; NULL selects the defaults
+ */
+void speedControl_init(const speedControlConfig_t* config);
+
+/**
+ * Sets the target speed. 0 turns the motor off and clears the integrator.
+ *
+ * @param rpm  target speed in revolutions per minute
+ */
+void speedControl_setTarget(uint16_t rpm);
+
+/**
+ * Adds the controller task to the scheduler.
+ */
+void speedControl_start(void);
+
+/**
+ * Removes the controller task from the scheduler and turns the motor off.
+ */
+void speedControl_stop(void);
+
+/**
+ * Runs one controller step, without touching the PWM. Used by the task,
+ * can also be fed with a simulated speed.
+ *
+ * @param measuredRpm  current speed in revolutions per minute
+ * @return             new duty cycle
+ */
+uint8_t speedControl_step(uint16_t measuredRpm);
+
+/**
+ * Last duty cycle commanded by the controller.
+ */
+uint8_t speedControl_getDuty(void);
+
+#endif /* SES_SPEEDCONTROL_H_ */
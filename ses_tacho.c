@@ -0,0 +1,224 @@
+/*
+ ***************************************************************************
+ ses_tacho V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_tacho is a library that measures the period of the motor pulses with
+ the input capture unit of timer 3. The timer latches the edge time in
+ hardware, the capture ISR only extends it to 32 bit and builds the
+ difference to the previous pulse. Converting the period to a frequency is
+ left to the task context.
+
+ With PWM_16BIT the timer also drives the motor PWM. ses_pwm then owns the
+ timer configuration and the overflow interrupt, this module only uses the
+ capture interrupt and takes the 32 bit timebase from pwm_extendTime.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_tacho.h"
+#include "util/atomic.h"
+#ifdef PWM_16BIT
+#include "ses_pwm.h"
+#endif
+
+/* DEFINES & MACROS **********************************************************/
+
+#if defined(PWM_16BIT) && (PWM_TIMEBASE_CYCLES * TACHO_TICKS_PER_SEC != F_CPU)
+#error "the timebase of ses_pwm does not match TACHO_TICKS_PER_SEC"
+#endif
+
+#define TACHO_CAPTURE_PORT               PORTE
+#define TACHO_CAPTURE_PIN                PE7
+
+#define TIMER3_REGISTER					 TCNT3
+#define TIMER3_CONTROL_REGISTER_3A   	 TCCR3A
+#define TIMER3_CONTROL_REGISTER_3B   	 TCCR3B
+#define TIMER3_CAPTURE_REGISTER          ICR3
+#define TIMER_INTERRUPT_MASK_3		 	 TIMSK3
+#define TIMER_INTERRUPT_FLAG_REGISTER3	 TIFR3
+#define POWER_REDUCTION_REGISTER_1    	 PRR1
+
+/* PRIVATE VARIABLES *********************************************************/
+
+#ifndef PWM_16BIT
+static volatile uint16_t overflowCount = 0; /* upper 16 bit of the timebase */
+#endif
+static volatile uint32_t lastCapture = 0;
+static volatile uint32_t period = 0;
+static bool firstCapture = true;
+
+volatile pTachoCallback myTachoCallback = NULL;
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+#ifndef PWM_16BIT
+
+/*
+ * extends a timer value to 32 bit, called with interrupts disabled
+ */
+static uint32_t tacho_extendTime(uint16_t low) {
+
+	uint16_t high = overflowCount;
+
+	/*
+	 * if the overflow is pending, the value was taken either just before
+	 * it (high value) or after it (low value, count not updated yet)
+	 */
+	if ((TIMER_INTERRUPT_FLAG_REGISTER3 & (1 << TOV3)) && low < 0x8000) {
+		high++;
+	}
+	return ((uint32_t) high << 16) | low;
+}
+
+#else
+
+static inline uint32_t tacho_extendTime(uint16_t low) {
+	return pwm_extendTime(low);
+}
+
+#endif /* PWM_16BIT */
+
+/* FUNCTION DEFINITION *******************************************************/
+
+#ifdef PWM_16BIT
+
+/*
+ * timer 3 runs the PWM, pwm_init16 sets mode and prescaler and has to be
+ * called first
+ */
+void tacho_init(void) {
+
+	DDR_REGISTER(TACHO_CAPTURE_PORT) &= ~(1 << TACHO_CAPTURE_PIN);
+	TACHO_CAPTURE_PORT |= (1 << TACHO_CAPTURE_PIN);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		lastCapture = 0;
+		period = 0;
+		firstCapture = true;
+	}
+
+	pwm_enableCapture();
+
+	TIMER_INTERRUPT_FLAG_REGISTER3 = (1 << ICF3);
+	TIMER_INTERRUPT_MASK_3 |= (1 << ICIE3);
+
+	sei();
+}
+
+#else
+
+void tacho_init(void) {
+
+	DDR_REGISTER(TACHO_CAPTURE_PORT) &= ~(1 << TACHO_CAPTURE_PIN);
+	TACHO_CAPTURE_PORT |= (1 << TACHO_CAPTURE_PIN);
+
+	POWER_REDUCTION_REGISTER_1 &= ~(1 << PRTIM3);
+
+	/*
+	 * normal mode, the timer runs over the full 16 bit range
+	 */
+	TIMER3_CONTROL_REGISTER_3A = 0;
+
+	/*
+	 * noise canceler on, capture on rising edges, prescaler 64. The noise
+	 * canceler delays every capture by the same 4 cycles, so it adds no
+	 * jitter to the period.
+	 */
+	TIMER3_CONTROL_REGISTER_3B = (1 << ICNC3) | (1 << ICES3) | (1 << CS31)
+			| (1 << CS30);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		TIMER3_REGISTER = 0;
+		overflowCount = 0;
+		lastCapture = 0;
+		period = 0;
+		firstCapture = true;
+	}
+
+	TIMER_INTERRUPT_FLAG_REGISTER3 = (1 << ICF3) | (1 << TOV3);
+	TIMER_INTERRUPT_MASK_3 |= (1 << ICIE3) | (1 << TOIE3);
+
+	sei();
+}
+
+#endif /* PWM_16BIT */
+
+void tacho_setCaptureCallback(pTachoCallback cb) {
+	myTachoCallback = cb;
+}
+
+uint32_t tacho_getPeriod(void) {
+
+	uint32_t value;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = period;
+	}
+	return value;
+}
+
+uint32_t tacho_getLastCapture(void) {
+
+	uint32_t value;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = lastCapture;
+	}
+	return value;
+}
+
+uint32_t tacho_getTime(void) {
+
+	uint32_t value;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = tacho_extendTime(TIMER3_REGISTER);
+	}
+	return value;
+}
+
+uint32_t tacho_getElapsed(void) {
+
+	uint32_t value;
+
+	/* one block, a capture between two reads would make it negative */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = tacho_extendTime(TIMER3_REGISTER) - lastCapture;
+	}
+	return value;
+}
+
+ISR(TIMER3_CAPT_vect) {
+
+	uint32_t capture = tacho_extendTime(TIMER3_CAPTURE_REGISTER);
+
+	if (firstCapture) {
+		firstCapture = false;
+	} else {
+		period = capture - lastCapture;
+
+		pTachoCallback callback = myTachoCallback;
+		if (callback != NULL) {
+			callback(period);
+		}
+	}
+	lastCapture = capture;
+}
+
+#ifndef PWM_16BIT
+
+ISR(TIMER3_OVF_vect) {
+	overflowCount++;
+}
+
+#endif /* PWM_16BIT */
@@ -0,0 +1,76 @@
+#ifndef SES_TACHO_H_
+#define SES_TACHO_H_
+
+/*INCLUDES *******************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ses_common.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+/*
+ * timer 3 runs with prescaler 64, one tick is 4 us. With PWM_16BIT the
+ * ticks come from the timebase of ses_pwm, which has the same unit.
+ */
+#define TACHO_TICKS_PER_SEC        250000UL
+
+/* TYPES ********************************************************************/
+
+/**type of function pointer called from the capture ISR with the period
+ * between the last two pulses in ticks
+ */
+typedef void (*pTachoCallback)(uint32_t period);
+
+/* FUNCTION PROTOTYPES *******************************************************/
+
+/**
+ * Initializes the tachometer on the input capture unit of timer 3. The
+ * timer hardware latches the timestamp of every rising edge on ICP3 (PE7),
+ * so the measured period does not depend on interrupt latency. The pulse
+ * signal of the motor has to be connected to PE7. Timestamps are extended
+ * to 32 bit with the timer overflows. With PWM_16BIT the timer is shared
+ * with the PWM output on OC3B, pwm_init16 or pwm_init has to run first.
+ */
+void tacho_init(void);
+
+/**
+ * Sets a function to be called from the capture ISR for every period.
+ * Keep it short, conversions belong into task context.
+ *
+ * @param cb  pointer to the callback function; if NULL, no callback
+ *            will be executed.
+ */
+void tacho_setCaptureCallback(pTachoCallback cb);
+
+/**
+ * Reads the last period atomically.
+ *
+ * @return period between the last two pulses in ticks, 0 before two
+ *         pulses were captured
+ */
+uint32_t tacho_getPeriod(void);
+
+/**
+ * Reads the timestamp of the last pulse atomically.
+ *
+ * @return timestamp in ticks
+ */
+uint32_t tacho_getLastCapture(void);
+
+/**
+ * Reads the current time of the tachometer timebase atomically.
+ *
+ * @return time in ticks, same timebase as the captures
+ */
+uint32_t tacho_getTime(void);
+
+/**
+ * Reads the time since the last pulse, the current time and the
+ * timestamp of the pulse are taken together atomically.
+ *
+ * @return time in ticks
+ */
+uint32_t tacho_getElapsed(void);
+
+#endif /* SES_TACHO_H_ */
@@ -119,6 +119,22 @@
 #define TIMER5_OUTPUT_COMPARE_REG        OCR5A
 #define TIMER5_CYC_FOR_HALF_SEC            32768
 
+/*************** Macros configuration for timer 4******************************/
+
+#define TIMER4_REGISTER					 TCNT4
+#define TIMER4_CONTROL_REGISTER_4A   	 TCCR4A
+#define TIMER4_CONTROL_REGISTER_4B   	 TCCR4B
+#define TIMER_INTERRUPT_MASK_4		 	 TIMSK4
+#define TIMER_OUTPUT_COMPARE_MATCH_4A	 OCIE4A
+#define TIMER_INTERRUPT_FLAG_REGISTER4	 TIFR4
+#define TIMER4_OUTPUT_COMPARE_REG        OCR4A
+#define POWER_REDUCTION_REGISTER_1    	 PRR1
+
+/*
+ * prescaler 64 gives 4 us per timer step
+ */
+#define TIMER4_US_PER_CYC                4
+
 /*************** Macros configuration for timer 0******************************/
 #define POWER_REDUCTION_REGISTER    	PRR0
 #define Timer0_CONTROL_REGISTER_A   	TCCR0A
@@ -312,11 +328,10 @@ void timer1_start() {
 	TIMER1_CONTROL_REGISTER_1B &= ~(1 << WAVEFORM_GENRATION_MODE_1_3);
 
 	/*
-	 * Global Interrupts are enabled.
+	 * Global interrupts are not touched here: timer1_start is called from
+	 * the pin change ISR in adaptive debouncing, the init functions of
+	 * the button driver enable them once.
 	 */
-
-	sei();
-
 }
 
 void timer1_stop() {
@@ -416,6 +431,63 @@ void timer5_stop(void) {
 
 }
 
+void timer4_start(uint16_t periodUs) {
+
+	POWER_REDUCTION_REGISTER_1 &= ~(1 << PRTIM4);
+
+	/*
+	 * configure the prescaler to 64
+	 */
+
+	TIMER4_CONTROL_REGISTER_4B |= (1 << CS40);
+	TIMER4_CONTROL_REGISTER_4B |= (1 << CS41);
+	TIMER4_CONTROL_REGISTER_4B &= ~(1 << CS42);
+
+	TIMER_INTERRUPT_MASK_4 |= (1 << TIMER_OUTPUT_COMPARE_MATCH_4A);
+
+	TIMER_INTERRUPT_FLAG_REGISTER4 |= (1 << OCF4A);
+
+	unsigned char sreg = SREG;
+	cli();
+	TIMER4_OUTPUT_COMPARE_REG = (periodUs / TIMER4_US_PER_CYC) - 1;
+	SREG = sreg;
+
+	/*
+	 *setting the operation mode for CTC
+	 */
+	TIMER4_CONTROL_REGISTER_4A &= ~(1 << WGM40);
+	TIMER4_CONTROL_REGISTER_4A &= ~(1 << WGM41);
+	TIMER4_CONTROL_REGISTER_4B |= (1 << WGM42);
+	TIMER4_CONTROL_REGISTER_4B &= ~(1 << WGM43);
+
+	/*
+	 * Global Interrupts are enabled.
+	 */
+
+	sei();
+}
+
+void timer4_stop(void) {
+
+	/*
+	 * Interrupts are disabled.
+	 */
+
+	TIMER_INTERRUPT_MASK_4 &= ~(1 << TIMER_OUTPUT_COMPARE_MATCH_4A);
+
+	/*
+	 * The clock is disabled.
+	 */
+	TIMER4_CONTROL_REGISTER_4B &= ~(1 << CS40);
+	TIMER4_CONTROL_REGISTER_4B &= ~(1 << CS41);
+	TIMER4_CONTROL_REGISTER_4B &= ~(1 << CS42);
+
+	unsigned char sreg = SREG;
+	cli();
+	TIMER4_REGISTER = INITIALIZE_TIMER;   // set timer to 0
+	SREG = sreg;
+}
+
 ISR(TIMER1_COMPA_vect) {
 	/*
 	 * If the global myTimerCallback1 is not NULL.
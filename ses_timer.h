@@ -67,6 +67,19 @@ void timer0_start(void);
  */
 void timer0_stop(void);
 
+/**
+ * Start timer 4 in CTC mode to trigger TIMER4_COMPA_vect periodically.
+ * The ISR is provided by the user of the timer (e.g. ses_rotary).
+ *
+ * @param periodUs  period in us, multiple of 4, at least 8
+ */
+void timer4_start(uint16_t periodUs);
+
+/**
+ * Stops timer 4.
+ */
+void timer4_stop(void);
+
 /**
  * Start timer 5.
  */
@@ -0,0 +1,280 @@
+/*
+ ***************************************************************************
+ ses_uart V1 - Copyright (C) 2018 MOSTAFA HASSAN & HAZEM ABAZA.
+ ***************************************************************************
+ This file is part of the SES_TUHH library.
+
+ ses_uart replaces the blocking libuart with an interrupt driven driver
+ for USART1 (same pins, frame format and baud rate calculation). Written
+ characters are copied into a transmit ring, the data register empty
+ interrupt sends them in the background; received characters are put
+ into a receive ring by the receive interrupt. A task logging through
+ uartout therefore only pays for the copy, unless the ring is full.
+
+ ***************************************************************************
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include "ses_uart.h"
+#include "ses_common.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "util/atomic.h"
+
+/* DEFINES & MACROS **********************************************************/
+
+#define UART_TX_MASK             (UART_TX_BUFFER_SIZE - 1)
+#define UART_RX_MASK             (UART_RX_BUFFER_SIZE - 1)
+
+/* the baud rate divisor is computed from the CPU clock */
+#ifndef F_CPU
+#error "F_CPU must be defined, e.g. -DF_CPU=16000000UL"
+#endif
+
+#if (UART_TX_BUFFER_SIZE & UART_TX_MASK) != 0 || UART_TX_BUFFER_SIZE > 256
+#error "UART_TX_BUFFER_SIZE must be a power of two up to 256"
+#endif
+#if (UART_RX_BUFFER_SIZE & UART_RX_MASK) != 0 || UART_RX_BUFFER_SIZE > 256
+#error "UART_RX_BUFFER_SIZE must be a power of two up to 256"
+#endif
+
+/* characters copied per interrupt lock in uart_write */
+#define UART_WRITE_CHUNK         16
+
+/* double speed mode, as in libuart */
+#define UART_STATUS_CONFIG       _BV(U2X1)
+
+/* PRIVATE VARIABLES *********************************************************/
+
+static uint8_t txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint8_t txHead = 0; /* next slot to write, writers only */
+static volatile uint8_t txTail = 0; /* next slot to send, UDRE ISR only */
+static volatile bool txStarted = false;
+
+static uint8_t rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8_t rxHead = 0; /* next slot to write, RX ISR only */
+static volatile uint8_t rxTail = 0; /* next slot to read, readers only */
+
+static volatile bool blockingMode = true;
+static volatile uint16_t droppedCount = 0;
+
+static int uart_putcProxy(char chr, FILE* stream);
+
+static FILE uartStream = FDEV_SETUP_STREAM(uart_putcProxy, NULL,
+		_FDEV_SETUP_WRITE);
+
+FILE* uartout = &uartStream;
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static int uart_putcProxy(char chr, FILE* stream) {
+
+	uart_putc((uint8_t) chr);
+	return 0;
+}
+
+static inline void uart_countDropped(uint16_t count) {
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (count > 0xFFFF - droppedCount) {
+			droppedCount = 0xFFFF;
+		} else {
+			droppedCount += count;
+		}
+	}
+}
+
+/*
+ * sends the next queued character, or stops the UDRE interrupt when the
+ * ring is empty; called with interrupts disabled
+ */
+static inline void uart_sendNext(void) {
+
+	uint8_t tail = txTail;
+
+	if (tail == txHead) {
+		UCSR1B &= ~_BV(UDRIE1);
+		return;
+	}
+
+	/* writing TXC1 clears it, uart_flush waits for it to be set again */
+	UCSR1A = UART_STATUS_CONFIG | _BV(TXC1);
+	UDR1 = txBuffer[tail];
+	txTail = (tail + 1) & UART_TX_MASK;
+	txStarted = true;
+}
+
+static inline void uart_receive(void) {
+
+	uint8_t chr = UDR1;
+	uint8_t next = (rxHead + 1) & UART_RX_MASK;
+
+	/* a full ring keeps the oldest characters */
+	if (next == rxTail) {
+		if (droppedCount != 0xFFFF) {
+			droppedCount++;
+		}
+		return;
+	}
+
+	rxBuffer[rxHead] = chr;
+	rxHead = next;
+}
+
+/*
+ * with interrupts disabled (e.g. logging from an ISR) the UART interrupts
+ * cannot run, the waiting loops move the characters by polling instead
+ */
+static void uart_pollTransmit(void) {
+
+	if (!(SREG & _BV(SREG_I)) && (UCSR1A & _BV(UDRE1))) {
+		uart_sendNext();
+	}
+}
+
+static void uart_pollReceive(void) {
+
+	if (!(SREG & _BV(SREG_I)) && (UCSR1A & _BV(RXC1))) {
+		uart_receive();
+	}
+}
+
+/* FUNCTION DEFINITION *******************************************************/
+
+void uart_init(uint32_t baudrate) {
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		txHead = 0;
+		txTail = 0;
+		txStarted = false;
+		rxHead = 0;
+		rxTail = 0;
+		droppedCount = 0;
+
+		/* F_CPU / (8 * baudrate) - 1 rounded to nearest, as libuart */
+		UBRR1 = (uint16_t) ((F_CPU + 4 * baudrate) / (8 * baudrate) - 1);
+		UCSR1A = UART_STATUS_CONFIG;
+		UCSR1C = _BV(UCSZ11) | _BV(UCSZ10);
+		UCSR1B = _BV(RXCIE1) | _BV(RXEN1) | _BV(TXEN1);
+	}
+}
+
+uint8_t uart_getc() {
+
+	uint8_t chr;
+
+	while (!uart_tryGetc(&chr)) {
+		uart_pollReceive();
+	}
+	return chr;
+}
+
+void uart_putc(uint8_t chr) {
+	uart_write(&chr, 1);
+}
+
+uint16_t uart_write(const uint8_t* data, uint16_t length) {
+
+	uint16_t written = 0;
+
+	while (written < length) {
+
+		uint8_t copied = 0;
+
+		/*
+		 * the copy is split into short locked chunks, so writers in
+		 * different contexts cannot interleave inside the ring while
+		 * interrupts stay blocked for a few microseconds at most
+		 */
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			uint8_t head = txHead;
+			uint8_t space = (txTail - head - 1) & UART_TX_MASK;
+
+			if (space > UART_WRITE_CHUNK) {
+				space = UART_WRITE_CHUNK;
+			}
+			if (space > length - written) {
+				space = length - written;
+			}
+
+			while (copied < space) {
+				txBuffer[head] = data[written + copied];
+				head = (head + 1) & UART_TX_MASK;
+				copied++;
+			}
+
+			if (copied != 0) {
+				txHead = head;
+				UCSR1B |= _BV(UDRIE1);
+			}
+		}
+
+		written += copied;
+
+		if (copied == 0) {
+			if (!blockingMode) {
+				uart_countDropped(length - written);
+				break;
+			}
+			uart_pollTransmit();
+		}
+	}
+	return written;
+}
+
+void uart_setBlocking(bool blocking) {
+	blockingMode = blocking;
+}
+
+bool uart_tryGetc(uint8_t* chr) {
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (rxTail == rxHead) {
+			return false;
+		}
+		*chr = rxBuffer[rxTail];
+		rxTail = (rxTail + 1) & UART_RX_MASK;
+	}
+	return true;
+}
+
+uint8_t uart_available(void) {
+	return (rxHead - rxTail) & UART_RX_MASK;
+}
+
+void uart_flush(void) {
+
+	while (txTail != txHead) {
+		uart_pollTransmit();
+	}
+
+	/* the last character may still be in the shift register */
+	if (txStarted) {
+		while (!(UCSR1A & _BV(TXC1))) {
+		}
+	}
+}
+
+uint16_t uart_getDroppedCount(void) {
+
+	uint16_t count;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		count = droppedCount;
+	}
+	return count;
+}
+
+ISR(USART1_UDRE_vect) {
+	uart_sendNext();
+}
+
+ISR(USART1_RX_vect) {
+	uart_receive();
+}
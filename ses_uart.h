@@ -4,6 +4,17 @@
 /*INCLUDES-------------------------------------------------------------------*/
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
+
+/*DEFINES--------------------------------------------------------------------*/
+
+/* ring buffer sizes in bytes, powers of two up to 256 */
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE      128
+#endif
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE      32
+#endif
 
 /*EXTERNALS------------------------------------------------------------------*/
 
@@ -17,21 +28,64 @@ extern FILE* uartout;
 
 /**
  * Initializes UART with given baud rate. By default, 8 databits and
- * 1 stop bit are used.
+ * 1 stop bit are used. Sending and receiving are interrupt driven, global
+ * interrupts have to be enabled (sei) for characters to go out.
  * @param baudrate	baudrate of uart (e.g. 57600)
  */
 void uart_init(uint32_t baudrate);
 
 /**
- *	Reads a character from UART.
+ *	Reads a character from UART, waits until one was received.
  *	@return character
  */
 uint8_t uart_getc();
 
 /**
- * Writes a character to UART.
+ * Writes a character to UART. The character is queued, the call only
+ * waits while the transmit buffer is full (in blocking mode).
  * @param chr character to write
  */
 void uart_putc(uint8_t chr);
 
+/**
+ * Queues a block of characters with one interrupt lock per free span of
+ * the buffer.
+ * @param data   characters to write
+ * @param length number of characters
+ * @return number of characters queued, less than length only in
+ *         non-blocking mode
+ */
+uint16_t uart_write(const uint8_t* data, uint16_t length);
+
+/**
+ * Selects what happens when the transmit buffer is full: blocking mode
+ * (default) waits for space, non-blocking mode drops the characters that
+ * do not fit and counts them.
+ * @param blocking	true for blocking mode
+ */
+void uart_setBlocking(bool blocking);
+
+/**
+ * Reads a character without waiting.
+ * @param chr written with the character
+ * @return false, if nothing was received
+ */
+bool uart_tryGetc(uint8_t* chr);
+
+/**
+ * @return number of received characters waiting in the buffer
+ */
+uint8_t uart_available(void);
+
+/**
+ * Waits until all queued characters were sent, e.g. before sleeping.
+ */
+void uart_flush(void);
+
+/**
+ * @return characters dropped by a full transmit buffer (non-blocking mode)
+ *         or a full receive buffer, saturates at 0xFFFF
+ */
+uint16_t uart_getDroppedCount(void);
+
 #endif /* SES_UART_H_ */
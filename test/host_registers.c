@@ -0,0 +1,10 @@
+/*
+ * Storage for the registers declared in stub/avr/io.h.
+ */
+#include <avr/io.h>
+
+volatile uint8_t SREG;
+volatile uint8_t hostPorts[6];
+volatile uint16_t TCNT5;
+volatile uint16_t OCR5A;
+volatile uint8_t OCR0B;
@@ -0,0 +1,12 @@
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+/* an ISR becomes a plain function the test can call */
+#define ISR(vector, ...)         void vector(void)
+
+#define sei()                    (SREG |= _BV(SREG_I))
+#define cli()                    (SREG &= ~_BV(SREG_I))
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
@@ -0,0 +1,35 @@
+/*
+ * Host stand-in for <avr/io.h>: the registers used by the modules under
+ * test are plain variables, defined in host_registers.c.
+ */
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit)                 (1 << (bit))
+
+extern volatile uint8_t SREG;
+#define SREG_I                   7
+
+/* I/O ports, PINx, DDRx and PORTx are adjacent as on the AVR */
+extern volatile uint8_t hostPorts[6];
+#define PINF                     hostPorts[0]
+#define DDRF                     hostPorts[1]
+#define PORTF                    hostPorts[2]
+#define PING                     hostPorts[3]
+#define DDRG                     hostPorts[4]
+#define PORTG                    hostPorts[5]
+#define PF6                      6
+#define PF7                      7
+#define PG1                      1
+#define PG5                      5
+
+/* timer 0 */
+extern volatile uint8_t OCR0B;
+
+/* timer 5 */
+extern volatile uint16_t TCNT5;
+extern volatile uint16_t OCR5A;
+
+#endif /* HOST_AVR_IO_H_ */
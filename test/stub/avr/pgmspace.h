@@ -0,0 +1,16 @@
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/* flash and RAM are the same address space on the host */
+#define PROGMEM
+#define PSTR(s)                  (s)
+#define PGM_P                    const char*
+#define pgm_read_byte(address)   (*(const uint8_t*) (address))
+#define pgm_read_word(address)   (*(const uint16_t*) (address))
+#define pgm_read_dword(address)  (*(const uint32_t*) (address))
+#define memcpy_P                 memcpy
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -0,0 +1,18 @@
+#ifndef HOST_STDIO_H_
+#define HOST_STDIO_H_
+
+#include_next <stdio.h>
+
+/*
+ * avr-libc stream setup on a glibc FILE. The put function is only stored,
+ * the host tests write into streams with the module functions or into
+ * host streams (fmemopen) instead.
+ */
+#define _FDEV_SETUP_WRITE        0
+#define FDEV_SETUP_STREAM(put, get, flags) { ._IO_buf_base = (char*) (put) }
+#define fdev_setup_stream(stream, put, get, flags) \
+	((stream)->_IO_buf_base = (char*) (put))
+#define fdev_set_udata(stream, u) ((stream)->_IO_save_base = (char*) (u))
+#define fdev_get_udata(stream)   ((void*) (stream)->_IO_save_base)
+
+#endif /* HOST_STDIO_H_ */
@@ -0,0 +1,9 @@
+#ifndef HOST_UTIL_ATOMIC_H_
+#define HOST_UTIL_ATOMIC_H_
+
+/* the host tests are single threaded, a block simply runs once */
+#define ATOMIC_RESTORESTATE      0
+#define ATOMIC_FORCEON           0
+#define ATOMIC_BLOCK(type)       for (int atomicOnce_ = 1; atomicOnce_; atomicOnce_ = 0)
+
+#endif /* HOST_UTIL_ATOMIC_H_ */
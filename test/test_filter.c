@@ -0,0 +1,170 @@
+/*
+ * ses_filter: every filter against a naive reference on random input,
+ * plus the host time per sample of each filter.
+ */
+#include <stdio.h>
+#include <time.h>
+#include "ses_filter.h"
+
+#define SAMPLES          100000
+#define BENCH_SAMPLES    2000000
+
+FILTER_MOVING_AVERAGE(average8, 3);
+FILTER_MOVING_AVERAGE(average256, 8);
+FILTER_IIR(iir, 3);
+FILTER_MEDIAN(median, 7);
+FILTER_DECIMATOR(decimator, 2);
+FILTER_DECIMATOR(decimator128, FILTER_MAX_DECIMATOR_LOG2);
+
+static int failures = 0;
+
+static void check(int ok, const char* what, long i) {
+	if (!ok && failures++ < 10) {
+		printf("FAIL %s at sample %ld\n", what, i);
+	}
+}
+
+static filter_sample_t history[SAMPLES];
+
+static void test_average(filter_movingAverage_t* f, uint16_t window) {
+
+	filter_reset(FILTER_TYPE_MOVING_AVERAGE, f);
+	for (long i = 0; i < SAMPLES; i++) {
+		uint32_t sum = 0;
+		filter_sample_t out = filter_movingAverageProcess(f, history[i]);
+
+		/* the window starts filled with zeros */
+		for (long k = i - window + 1; k <= i; k++) {
+			sum += (k >= 0) ? history[k] : 0;
+		}
+		check(out == sum / window, "moving average", i);
+	}
+}
+
+static void test_median(void) {
+
+	filter_reset(FILTER_TYPE_MEDIAN, &median);
+	for (long i = 0; i < SAMPLES; i++) {
+		filter_sample_t window[7] = { 0 };
+		uint8_t n = 0;
+		filter_sample_t out = filter_medianProcess(&median, history[i]);
+
+		for (long k = (i >= 6) ? i - 6 : 0; k <= i; k++) {
+			uint8_t j = n++;
+			while (j > 0 && window[j - 1] > history[k]) {
+				window[j] = window[j - 1];
+				j--;
+			}
+			window[j] = history[k];
+		}
+		check(out == window[n >> 1], "median", i);
+	}
+}
+
+static void test_iirAndDecimator(void) {
+
+	int32_t state = (int32_t) history[0] << 8;
+	uint32_t blockSum = 0;
+
+	filter_reset(FILTER_TYPE_IIR, &iir);
+	filter_reset(FILTER_TYPE_DECIMATOR, &decimator);
+
+	for (long i = 0; i < SAMPLES; i++) {
+		filter_sample_t out;
+		bool done;
+
+		if (i > 0) {
+			state += (((int32_t) history[i] << 8) - state) >> 3;
+		}
+		check(filter_iirProcess(&iir, history[i]) == ((state + 128) >> 8),
+				"iir", i);
+
+		blockSum += history[i];
+		done = filter_decimatorProcess(&decimator, history[i], &out);
+		check(done == ((i & 3) == 3), "decimator block", i);
+		if (done) {
+			check(out == blockSum / 4, "decimator mean", i);
+			blockSum = 0;
+		}
+	}
+}
+
+/* the largest factor still completes its blocks */
+static void test_largestDecimator(void) {
+
+	uint32_t blockSum = 0;
+
+	filter_reset(FILTER_TYPE_DECIMATOR, &decimator128);
+
+	for (long i = 0; i < SAMPLES; i++) {
+		filter_sample_t out;
+		bool done;
+
+		blockSum += history[i];
+		done = filter_decimatorProcess(&decimator128, history[i], &out);
+		check(done == ((i & 127) == 127), "decimator128 block", i);
+		if (done) {
+			check(out == blockSum / 128, "decimator128 mean", i);
+			blockSum = 0;
+		}
+	}
+}
+
+static double nsPerSample(uint8_t type, void* filter) {
+
+	struct timespec start, end;
+	volatile filter_sample_t sink = 0;
+	filter_sample_t out;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (long i = 0; i < BENCH_SAMPLES; i++) {
+		filter_sample_t x = history[i % SAMPLES];
+		switch (type) {
+		case FILTER_TYPE_MOVING_AVERAGE:
+			sink = filter_movingAverageProcess(filter, x);
+			break;
+		case FILTER_TYPE_IIR:
+			sink = filter_iirProcess(filter, x);
+			break;
+		case FILTER_TYPE_MEDIAN:
+			sink = filter_medianProcess(filter, x);
+			break;
+		default:
+			if (filter_decimatorProcess(filter, x, &out)) {
+				sink = out;
+			}
+			break;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	(void) sink;
+
+	return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec))
+			/ BENCH_SAMPLES;
+}
+
+int main(void) {
+
+	srand(26);
+	for (long i = 0; i < SAMPLES; i++) {
+		/* 10 bit ADC like values */
+		history[i] = rand() & 0x3FF;
+	}
+
+	test_average(&average8, 8);
+	test_average(&average256, 256);
+	test_median();
+	test_iirAndDecimator();
+	test_largestDecimator();
+
+	printf("host time per sample (ns): average %.1f, average256 %.1f, "
+			"iir %.1f, median7 %.1f, decimator %.1f\n",
+			nsPerSample(FILTER_TYPE_MOVING_AVERAGE, &average8),
+			nsPerSample(FILTER_TYPE_MOVING_AVERAGE, &average256),
+			nsPerSample(FILTER_TYPE_IIR, &iir),
+			nsPerSample(FILTER_TYPE_MEDIAN, &median),
+			nsPerSample(FILTER_TYPE_DECIMATOR, &decimator));
+
+	printf("%s\n", failures ? "FAILED" : "ok");
+	return failures != 0;
+}
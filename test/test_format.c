@@ -0,0 +1,214 @@
+/*
+ * ses_format against snprintf and exact integer references: padding with
+ * ' ' and '0', the sign before zeros, INT32_MIN, decimals of scaled values
+ * and the truncated decimals of Qn values up to Q24, on fixed cases and
+ * random values. The output goes through a host memory stream.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ses_format.h"
+
+#define SAMPLES          200000
+
+static char out[64];
+static int failures = 0;
+
+/* output of one format_xxx call as a string */
+#define FORMAT(call)                                                          \
+	do {                                                                      \
+		FILE* stream = fmemopen(out, sizeof(out), "w");                       \
+		call;                                                                 \
+		fclose(stream);                                                       \
+	} while (0)
+
+static void check(const char* what, const char* expected, long i) {
+	if (strcmp(out, expected) != 0 && failures++ < 10) {
+		printf("FAIL %s at %ld: \"%s\", expected \"%s\"\n", what, i, out,
+				expected);
+	}
+}
+
+/* sign, pad and body the way the formatter lays out a field */
+static void field(char* ref, int negative, const char* body, int width,
+		char pad) {
+
+	int used = (int) strlen(body) + (negative ? 1 : 0);
+	int fill = (width > used) ? width - used : 0;
+
+	if (pad == '0') {
+		sprintf(ref, "%s%.*s%s", negative ? "-" : "", fill,
+				"00000000000000000000", body);
+	} else {
+		sprintf(ref, "%.*s%s%s", fill, "                    ",
+				negative ? "-" : "", body);
+	}
+}
+
+static const uint32_t powers[] = { 1, 10, 100, 1000, 10000, 100000, 1000000,
+		10000000, 100000000, 1000000000 };
+
+static void decimalReference(char* ref, int32_t value, uint8_t decimals,
+		int width, char pad) {
+
+	uint32_t magnitude = value < 0 ? -(uint32_t) value : (uint32_t) value;
+	char body[32];
+
+	if (decimals == 0) {
+		sprintf(body, "%lu", (unsigned long) magnitude);
+	} else {
+		sprintf(body, "%lu.%0*lu", (unsigned long) (magnitude / powers[decimals]),
+				decimals % 10, (unsigned long) (magnitude % powers[decimals]));
+	}
+	field(ref, value < 0, body, width, pad);
+}
+
+static void fixedReference(char* ref, int32_t value, uint8_t fractionBits,
+		uint8_t decimals, int width, char pad) {
+
+	uint32_t magnitude = value < 0 ? -(uint32_t) value : (uint32_t) value;
+	uint64_t rest = magnitude & ((1UL << fractionBits) - 1);
+	char body[32];
+
+	sprintf(body, "%lu", (unsigned long) (magnitude >> fractionBits));
+	if (decimals != 0) {
+		/* truncated: floor(rest * 10^decimals / 2^fractionBits) */
+		sprintf(body + strlen(body), ".%0*llu", decimals % 10,
+				(unsigned long long) ((rest * powers[decimals])
+						>> fractionBits));
+	}
+	field(ref, value < 0, body, width, pad);
+}
+
+static int32_t randomValue(void) {
+
+	uint32_t value = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+
+	/* small values as often as large ones */
+	return (int32_t) (value >> (rand() % 32));
+}
+
+static void test_fixedCases(void) {
+
+	FORMAT(format_putUnsigned(stream, 0, 0, ' '));
+	check("unsigned 0", "0", 0);
+	FORMAT(format_putUnsigned(stream, 4294967295UL, 0, ' '));
+	check("unsigned max", "4294967295", 0);
+	FORMAT(format_putUnsigned(stream, 42, 5, ' '));
+	check("unsigned width", "   42", 0);
+	FORMAT(format_putUnsigned(stream, 42, 5, '0'));
+	check("unsigned zeros", "00042", 0);
+	FORMAT(format_putUnsigned(stream, 123456, 3, '0'));
+	check("unsigned wider than width", "123456", 0);
+	FORMAT(format_putSigned(stream, -42, 5, '0'));
+	check("signed zeros", "-0042", 0);
+	FORMAT(format_putSigned(stream, -42, 5, ' '));
+	check("signed width", "  -42", 0);
+	FORMAT(format_putSigned(stream, INT32_MIN, 0, ' '));
+	check("INT32_MIN", "-2147483648", 0);
+	FORMAT(format_putSigned(stream, INT32_MIN, 13, '0'));
+	check("INT32_MIN zeros", "-002147483648", 0);
+	FORMAT(format_putDecimal(stream, -2534, 2, 0, ' '));
+	check("decimal", "-25.34", 0);
+	FORMAT(format_putDecimal(stream, 5, 2, 0, ' '));
+	check("decimal below 1", "0.05", 0);
+	FORMAT(format_putDecimal(stream, -5, 3, 7, '0'));
+	check("decimal zeros", "-00.005", 0);
+	FORMAT(format_putDecimal(stream, INT32_MIN, 9, 0, ' '));
+	check("decimal INT32_MIN", "-2.147483648", 0);
+	FORMAT(format_putFixed(stream, 0x0180, 8, 2, 0, ' '));
+	check("fixed", "1.50", 0);
+	FORMAT(format_putFixed(stream, -0x0180, 8, 3, 0, ' '));
+	check("fixed negative", "-1.500", 0);
+	FORMAT(format_putFixed(stream, 0x0155, 8, 4, 0, ' '));
+	check("fixed truncated", "1.3320", 0);
+	FORMAT(format_putFixed(stream, 0x7FFFFFFF, 24, 6, 0, ' '));
+	check("fixed Q24", "127.999999", 0);
+	FORMAT(format_putFixed(stream, INT32_MIN, 24, 2, 9, '0'));
+	check("fixed Q24 INT32_MIN", "-00128.00", 0);
+	FORMAT(format_putFixed(stream, 0x0180, 30, 2, 0, ' '));
+	check("fixed bits limited to 24", "0.00", 0);
+	FORMAT(format_putHex(stream, 0xBEEF, 4));
+	check("hex", "BEEF", 0);
+	FORMAT(format_putHex(stream, 0xBEEF, 6));
+	check("hex zeros", "00BEEF", 0);
+	FORMAT(format_putHex(stream, 0x12345678, 2));
+	check("hex low digits", "78", 0);
+	FORMAT(format_putString_P(stream, PSTR("Temp")));
+	check("flash string", "Temp", 0);
+}
+
+static void test_random(void) {
+
+	char ref[64];
+
+	for (long i = 0; i < SAMPLES; i++) {
+		int32_t value = randomValue();
+		uint8_t width = rand() % 14;
+		char pad = (rand() & 1) ? '0' : ' ';
+		uint8_t decimals = rand() % 10;
+		uint8_t fractionBits = rand() % 25;
+
+		if (rand() & 1) {
+			value = -value;
+		}
+		if (i % 1000 == 0) {
+			value = INT32_MIN;
+		}
+
+		FORMAT(format_putUnsigned(stream, (uint32_t) value, width, pad));
+		snprintf(ref, sizeof(ref), pad == '0' ? "%0*lu" : "%*lu", width % 14,
+				(unsigned long) (uint32_t) value);
+		check("unsigned", ref, i);
+
+		FORMAT(format_putSigned(stream, value, width, pad));
+		snprintf(ref, sizeof(ref), pad == '0' ? "%0*ld" : "%*ld", width % 14,
+				(long) value);
+		check("signed", ref, i);
+
+		FORMAT(format_putDecimal(stream, value, decimals, width, pad));
+		decimalReference(ref, value, decimals, width, pad);
+		check("decimal", ref, i);
+
+		FORMAT(format_putFixed(stream, value, fractionBits, decimals, width,
+				pad));
+		fixedReference(ref, value, fractionBits, decimals, width, pad);
+		check("fixed", ref, i);
+
+		uint8_t digits = 1 + rand() % 8;
+		FORMAT(format_putHex(stream, (uint32_t) value, digits));
+		snprintf(ref, sizeof(ref), "%0*lX", digits % 9,
+				(unsigned long) ((uint32_t) value
+						& (0xFFFFFFFFUL >> (32 - 4 * digits))));
+		check("hex", ref, i);
+	}
+}
+
+/* the buffer stream drops what does not fit and stays terminated */
+static void test_buffer(void) {
+
+	formatBuffer_t buffer;
+	char data[5];
+	FILE* stream = format_openBuffer(&buffer, data, sizeof(data));
+	int (*put)(char, FILE*) = (int (*)(char, FILE*)) stream->_IO_buf_base;
+
+	strcpy(out, data);
+	check("empty buffer", "", 0);
+	for (const char* c = "123456"; *c != '\0'; c++) {
+		put(*c, stream);
+	}
+	strcpy(out, data);
+	check("full buffer", "1234", 0);
+}
+
+int main(void) {
+
+	srand(1);
+	test_fixedCases();
+	test_random();
+	test_buffer();
+
+	printf("%ld random values checked\n", (long) SAMPLES);
+	printf("%s\n", failures ? "FAILED" : "ok");
+	return failures != 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Flush of ses_framebuffer against a model of the two display controllers
+ * behind lcdDriver_*: page and column commands, a column that advances
+ * after every data byte and a busy flag that has to be polled before every
+ * command and data byte. Random frames are presented while a flush is
+ * running, after every flush the panel has to match the last frame.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ses_framebuffer.h"
+#include "ses_lcdDriver.h"
+#include "ses_scheduler.h"
+
+#define FRAMES           20000
+#define CONTROLLER_RAM   80
+
+const uint8_t font6x8[256 * FRAMEBUFFER_CHAR_WIDTH];
+
+static uint8_t panel[2][FRAMEBUFFER_PAGES][CONTROLLER_RAM];
+static uint8_t controllerPage[2];
+static uint8_t controllerColumn[2];
+static uint8_t selected = 0;
+static int busy = 0;
+
+static long commands = 0;
+static long data = 0;
+static int failures = 0;
+
+static void check(int ok, const char* what, long i) {
+	if (!ok && failures++ < 10) {
+		printf("FAIL %s at %ld\n", what, i);
+	}
+}
+
+void lcd_clear(void) {
+	memset(panel, 0, sizeof(panel));
+}
+
+bool scheduler_add(taskDescriptor* td) {
+	return true;
+}
+
+void lcdDriver_selectController(uint8_t controller) {
+	check(controller < 2, "controller number", controller);
+	selected = controller;
+}
+
+/* busy after every write until the status is read once */
+uint8_t lcdDriver_readStatus(void) {
+	uint8_t status = busy ? LCD_STATUS_BUSY : 0;
+	busy = 0;
+	return status;
+}
+
+void lcdDriver_writeCommand(uint8_t command) {
+
+	check(!busy, "command while busy", commands);
+	if ((command & 0xFC) == LCD_COMMAND_PAGE) {
+		controllerPage[selected] = command & 0x03;
+	} else {
+		check(command < LCD_CONTROLLER_COLUMNS, "column command", command);
+		controllerColumn[selected] = command;
+	}
+	busy = 1;
+	commands++;
+}
+
+void lcdDriver_writeData(uint8_t value) {
+
+	uint8_t column = controllerColumn[selected];
+
+	check(!busy, "data while busy", data);
+	check(column < LCD_CONTROLLER_COLUMNS, "data past the controller", data);
+	panel[selected][controllerPage[selected]][column] = value;
+	controllerColumn[selected] = (column + 1) % CONTROLLER_RAM;
+	busy = 1;
+	data++;
+}
+
+static uint8_t panelColumn(uint8_t page, uint8_t x) {
+	uint8_t controller = (x >= LCD_CONTROLLER_COLUMNS) ? 1 : 0;
+	return panel[controller][page][x - controller * LCD_CONTROLLER_COLUMNS];
+}
+
+static int panelMatches(void) {
+
+	for (uint8_t page = 0; page < FRAMEBUFFER_PAGES; page++) {
+		for (uint8_t x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+			if (panelColumn(page, x) != framebuffer_getColumn(page, x)) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/* changes count random columns, or a random run of them */
+static void drawRandom(int count) {
+
+	if (rand() & 1) {
+		for (int i = 0; i < count; i++) {
+			framebuffer_setColumn(rand() % FRAMEBUFFER_PAGES,
+					rand() % FRAMEBUFFER_WIDTH, rand());
+		}
+	} else {
+		uint8_t page = rand() % FRAMEBUFFER_PAGES;
+		uint8_t x = rand() % FRAMEBUFFER_WIDTH;
+		for (int i = 0; i < count; i++) {
+			framebuffer_setColumn(page, x + i, rand());
+		}
+	}
+}
+
+int main(void) {
+
+	framebuffer_init();
+
+	/* a full first frame */
+	for (uint8_t page = 0; page < FRAMEBUFFER_PAGES; page++) {
+		for (uint8_t x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+			framebuffer_setColumn(page, x, 0xA5 ^ x);
+		}
+	}
+	framebuffer_present();
+	int steps = 0;
+	while (framebuffer_isFlushing()) {
+		framebuffer_flushStep(FRAMEBUFFER_FLUSH_BYTES);
+		steps++;
+	}
+	check(panelMatches(), "full frame", 0);
+	printf("full frame: %ld data, %ld commands, %d steps\n", data, commands,
+			steps);
+
+	/* the blocking flush addresses every page of a controller once */
+	framebuffer_clear();
+	commands = 0;
+	data = 0;
+	framebuffer_flush();
+	check(panelMatches(), "cleared frame", 0);
+	check(commands == 2 * 2 * FRAMEBUFFER_PAGES, "commands of a full flush",
+			commands);
+	printf("blocking clear: %ld data, %ld commands\n", data, commands);
+
+	commands = 0;
+	data = 0;
+	for (long frame = 0; frame < FRAMES; frame++) {
+
+		drawRandom(1 + rand() % 40);
+		framebuffer_present();
+
+		/* a second frame arrives while the first is being flushed */
+		if (rand() & 1) {
+			framebuffer_flushStep(FRAMEBUFFER_FLUSH_BYTES);
+			drawRandom(1 + rand() % 40);
+			framebuffer_present();
+		}
+		while (framebuffer_isFlushing()) {
+			framebuffer_flushStep(FRAMEBUFFER_FLUSH_BYTES);
+		}
+		check(!framebuffer_isDirty(), "dirty after the flush", frame);
+		check(panelMatches(), "panel", frame);
+	}
+	printf("random frames: %.2f commands per data byte\n",
+			(double) commands / data);
+
+	printf("%s\n", failures ? "FAILED" : "ok");
+	return failures != 0;
+}
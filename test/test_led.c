@@ -0,0 +1,113 @@
+/*
+ * Slot timing of the LED dimming against a model of timer 5 in CTC mode:
+ * one timer clock every 256 CPU cycles, the counter is cleared when it
+ * equals OCR5A, and a CPU write to TCNT5 blocks the compare match of the
+ * next timer clock, as on the AVR. The compare interrupt is served after
+ * a random latency, a few of them later than whole slots. No slot may
+ * make the counter run past the frame (through 0xFFFF), also not the
+ * first one after led_dimStart.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "ses_led.h"
+#include "ses_timer.h"
+
+#define CYCLES_PER_TICK  256
+#define FRAME_TICKS      255
+#define RUN_TICKS        200000L
+
+static pTimerCallback tick = NULL;
+static int failures = 0;
+
+static void check(int ok, const char* what, long i) {
+	if (!ok && failures++ < 10) {
+		printf("FAIL %s at %ld\n", what, i);
+	}
+}
+
+void timer5_setCallback(pTimerCallback cb) {
+	tick = cb;
+}
+
+void timer5_start(void) {
+	OCR5A = 0x8000;
+}
+
+void timer5_stop(void) {
+}
+
+/*
+ * runs the timer for RUN_TICKS, late in 1/lateOdds of the interrupts by up
+ * to maxLate cycles, and returns the longest time between two interrupts
+ * in ticks
+ */
+static long run(int lateOdds, long maxLate) {
+
+	/* led_dimStart wrote the counter just before */
+	int blocked = 1;
+	int pending = 0;
+	long serveAt = 0;
+	long lastServed = 0;
+	long longest = 0;
+
+	for (long cycle = 0; cycle < RUN_TICKS * CYCLES_PER_TICK; cycle++) {
+
+		if (cycle % CYCLES_PER_TICK == 0) {
+			if (TCNT5 == OCR5A && !blocked) {
+				TCNT5 = 0;
+				if (!pending) {
+					pending = 1;
+					serveAt = cycle + rand() % 100;
+					if (rand() % lateOdds == 0) {
+						serveAt += rand() % (maxLate + 1);
+					}
+				}
+			} else {
+				TCNT5++;
+			}
+			blocked = 0;
+		}
+
+		if (pending && cycle >= serveAt) {
+			uint16_t counter = TCNT5;
+
+			pending = 0;
+			tick(NULL);
+			blocked = (TCNT5 != counter);
+
+			if (cycle - lastServed > longest) {
+				longest = cycle - lastServed;
+			}
+			lastServed = cycle;
+		}
+	}
+	return longest / CYCLES_PER_TICK;
+}
+
+int main(void) {
+
+	srand(1);
+	led_dimStart();
+	led_setBrightness(LED_ID_RED, 1);
+	led_setBrightness(LED_ID_YELLOW, 128);
+	led_setBrightness(LED_ID_GREEN, 200);
+
+	/* served within one timer clock, the slots are as long as designed */
+	long longest = run(1, 0);
+	printf("on time: longest slot %ld ticks\n", longest);
+	check(longest <= 128, "slot longer than the last slot", longest);
+
+	/* late by up to 3 slots of the frame, or more than a whole frame */
+	static const long late[] = { 300, 3000, 80000 };
+	for (int i = 0; i < 3; i++) {
+		led_dimStart();
+		longest = run(50, late[i]);
+		printf("late up to %5ld cycles: longest slot %ld ticks\n", late[i],
+				longest);
+		check(longest <= 128 + late[i] / CYCLES_PER_TICK + FRAME_TICKS,
+				"counter ran past the frame", late[i]);
+	}
+
+	printf("%s\n", failures ? "FAILED" : "ok");
+	return failures != 0;
+}
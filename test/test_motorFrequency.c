@@ -0,0 +1,156 @@
+/*
+ * Sliding window statistics of ses_motorFrequency against a naive
+ * recomputation over the last 2^MOTOR_STATS_WINDOW_LOG2 speeds. The pulse
+ * periods are fed through the tacho capture callback; monotonic runs fill
+ * the min/max deques completely.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "ses_motorFrequency.h"
+#include "ses_tacho.h"
+#include "ses_reciprocal.h"
+#include "ses_scheduler.h"
+#include "ses_led.h"
+
+#define WINDOW           (1 << MOTOR_STATS_WINDOW_LOG2)
+
+/* same conversion as ses_motorFrequency.c */
+#define SPIKES           5
+#define RPM_SCALE        6
+#define RPM_NUMERATOR    (TACHO_TICKS_PER_SEC * 60 / SPIKES / (1 << RPM_SCALE))
+
+static pTachoCallback capture = NULL;
+static taskDescriptor* watchdog = NULL;
+static uint32_t now = 0;
+
+void tacho_init(void) {
+}
+
+void tacho_setCaptureCallback(pTachoCallback cb) {
+	capture = cb;
+}
+
+uint32_t tacho_getPeriod(void) {
+	return 0;
+}
+
+uint32_t tacho_getLastCapture(void) {
+	return 0;
+}
+
+uint32_t tacho_getTime(void) {
+	return now;
+}
+
+uint32_t tacho_getElapsed(void) {
+	return now;
+}
+
+bool scheduler_add(taskDescriptor* td) {
+	watchdog = td;
+	return true;
+}
+
+void led_setBrightness(uint8_t led, uint8_t value) {
+}
+
+uint8_t led_getBrightness(uint8_t led) {
+	return 0;
+}
+
+static uint16_t rpmFromPeriod(uint16_t period) {
+
+	uint32_t rpm = reciprocal_divideScaled(RPM_NUMERATOR, period, RPM_SCALE);
+
+	return (rpm > 0xFFFF) ? 0xFFFF : (uint16_t) rpm;
+}
+
+/* next period of a random walk with monotonic runs and jumps */
+static uint16_t nextPeriod(uint16_t period) {
+
+	static int direction = 1;
+	static int runLength = 0;
+
+	if (runLength == 0) {
+		runLength = rand() % (3 * WINDOW);
+		direction = (rand() % 3) - 1;
+		if (rand() % 8 == 0) {
+			return 500 + rand() % 60000;
+		}
+	}
+	runLength--;
+
+	int next = period + direction * (rand() % 40) + (rand() % 5) - 2;
+	return (next < 500) ? 500 : (next > 60000) ? 60000 : next;
+}
+
+int main(void) {
+
+	uint16_t window[WINDOW];
+	uint16_t period = 5000;
+	unsigned long samples = 0;
+	int failures = 0;
+
+	srand(1);
+	motorFrequency_init();
+	motorSet(true);
+
+	for (int restart = 0; restart < 50 && failures < 10; restart++) {
+		/*
+		 * a stall resets the statistics, the first pulse after it only
+		 * starts the motor
+		 */
+		now += TACHO_TICKS_PER_SEC;
+		watchdog->task(watchdog->param);
+		now = 0;
+		capture(period);
+
+		for (int i = 0; i < 20000 && failures < 10; i++) {
+			uint16_t rpm;
+			uint32_t sum = 0;
+			uint16_t min = 0xFFFF;
+			uint16_t max = 0;
+			double variance = 0;
+			motorStats_t stats;
+
+			period = nextPeriod(period);
+			rpm = rpmFromPeriod(period);
+			capture(period);
+
+			if (i == 0) {
+				for (int j = 0; j < WINDOW; j++) {
+					window[j] = rpm;
+				}
+			}
+			window[i % WINDOW] = rpm;
+
+			for (int j = 0; j < WINDOW; j++) {
+				sum += window[j];
+				min = (window[j] < min) ? window[j] : min;
+				max = (window[j] > max) ? window[j] : max;
+			}
+			for (int j = 0; j < WINDOW; j++) {
+				double d = window[j] - (double) sum / WINDOW;
+				variance += d * d;
+			}
+			variance /= WINDOW;
+
+			motorFrequency_getStats(&stats);
+			samples++;
+			if (stats.min != min || stats.max != max
+					|| stats.mean != sum / WINDOW
+					|| stats.variance > variance + 1e-6
+					|| stats.variance + 1 < variance - 1e-6) {
+				printf("FAIL sample %d: min %u/%u max %u/%u mean %u/%u "
+						"variance %lu/%.1f\n", i, stats.min, min, stats.max,
+						max, stats.mean, (unsigned) (sum / WINDOW),
+						(unsigned long) stats.variance, variance);
+				failures++;
+			}
+		}
+	}
+
+	printf("%lu samples checked\n", samples);
+	printf("%s\n", failures ? "FAILED" : "ok");
+	return failures != 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * PWM ramp of ses_pwm (8 bit timer 0) on the real scheduler: the ramp is
+ * stepped from the timer 2 tick in interrupt context, reaches its target
+ * after the requested number of ticks, leaves the duty cycle alone between
+ * ramps and after pwm_rampStop, and calls its callback from a task, not
+ * from the interrupt. scheduler_run never returns, the callback check runs
+ * last and ends the program from inside the callback.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include "ses_pwm.h"
+#include "ses_scheduler.h"
+#include "ses_timer.h"
+
+void TIMER2_COMPA_vect(void);
+
+static int failures = 0;
+static int inInterrupt = 0;
+static int callbacks = 0;
+
+static void check(int ok, const char* what, long i) {
+	if (!ok && failures++ < 10) {
+		printf("FAIL %s at %ld\n", what, i);
+	}
+}
+
+void timer0_start(void) {
+}
+
+void timer2_start(void) {
+}
+
+static void tick(void) {
+	inInterrupt = 1;
+	TIMER2_COMPA_vect();
+	inInterrupt = 0;
+}
+
+/* a long running task in the list does not matter to the ramp */
+static void busyTask(void* param) {
+}
+
+static taskDescriptor busy = { .task = &busyTask, .param = NULL, .expire = 1,
+		.period = 1 };
+
+static void rampDone(void) {
+
+	check(!inInterrupt, "callback in interrupt context", 0);
+	callbacks++;
+	check(callbacks == 1, "callback count", callbacks);
+	check(OCR0B == 40, "duty at the callback", OCR0B);
+
+	printf("%s\n", failures ? "FAILED" : "ok");
+	exit(failures != 0);
+}
+
+static void timeout(int signal) {
+	printf("FAIL ramp callback never ran\nFAILED\n");
+	_exit(1);
+}
+
+/* runs a ramp to its end and checks the duty cycle on every tick */
+static void rampTo(uint8_t from, uint8_t to, uint16_t ms, uint8_t profile) {
+
+	pwm_setDutyCycle(from);
+	pwm_rampStart(to, ms, profile);
+
+	uint8_t previous = from;
+	for (uint16_t t = 1; t <= ms; t++) {
+		tick();
+		uint8_t duty = OCR0B;
+
+		check(to >= from ? duty >= previous : duty <= previous, "monotonic",
+				t);
+		check((t == ms) == (duty == to && pwm_rampIsDone()),
+				"target reached on the last tick only", t);
+		previous = duty;
+	}
+}
+
+int main(void) {
+
+	scheduler_init();
+	scheduler_add(&busy);
+	pwm_init();
+
+	rampTo(0, 255, 100, PWM_RAMP_LINEAR);
+	rampTo(255, 10, 300, PWM_RAMP_S_CURVE);
+	rampTo(10, 11, 1000, PWM_RAMP_LINEAR);
+
+	/* halfway through a linear ramp */
+	pwm_setDutyCycle(0);
+	pwm_rampStart(200, 100, PWM_RAMP_LINEAR);
+	for (int t = 0; t < 50; t++) {
+		tick();
+	}
+	check(OCR0B == 100, "linear halfway", OCR0B);
+
+	/* nothing writes the duty cycle after a stop or between ramps */
+	pwm_rampStop();
+	pwm_setDutyCycle(77);
+	for (int t = 0; t < 1000; t++) {
+		tick();
+	}
+	check(OCR0B == 77, "duty after stop", OCR0B);
+	check(pwm_rampIsDone(), "done after stop", 0);
+
+	/* a ramp started while one runs replaces it */
+	pwm_rampStart(0, 100, PWM_RAMP_LINEAR);
+	tick();
+	pwm_rampStart(150, 10, PWM_RAMP_LINEAR);
+	for (int t = 0; t < 10; t++) {
+		tick();
+	}
+	check(OCR0B == 150 && pwm_rampIsDone(), "replaced ramp", OCR0B);
+
+	/*
+	 * the callback: not called in the interrupt that finishes the ramp,
+	 * but by scheduler_run
+	 */
+	pwm_setRampCallback(&rampDone);
+	rampTo(150, 40, 20, PWM_RAMP_S_CURVE);
+	check(callbacks == 0, "callback before scheduler_run", callbacks);
+	tick();
+
+	signal(SIGALRM, &timeout);
+	alarm(2);
+	scheduler_run();
+	return 1;
+}
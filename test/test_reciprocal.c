@@ -0,0 +1,87 @@
+/*
+ * ses_reciprocal against the exact quotient: every 16 bit denominator
+ * with a set of numerators, then random pairs over the full 32 bit
+ * denominator range and all scales. The bounds are the ones documented
+ * in ses_reciprocal.h.
+ */
+#include <stdio.h>
+#include <math.h>
+#include "ses_reciprocal.h"
+
+#define RANDOM_PAIRS     20000000L
+
+static int failures = 0;
+static double worstRelative = 0;
+static double worstSmall = 0;
+
+static uint64_t state = 37;
+
+static uint32_t random32(void) {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return (uint32_t) state;
+}
+
+static void check(uint16_t numerator, uint32_t denominator, uint8_t scale) {
+
+	double exact = (double) numerator * (double) (1UL << scale) / denominator;
+	double result = (scale == 0) ?
+			reciprocal_divide(numerator, denominator) :
+			reciprocal_divideScaled(numerator, denominator, scale);
+	double error = fabs(result - floor(exact + 0.5));
+
+	/* below 10000 within 1 of the rounded quotient, above that 1e-4 */
+	double allowed = (exact < 10000) ? 1 : exact * 1e-4 + 1;
+
+	if (exact < 10000 && error > worstSmall) {
+		worstSmall = error;
+	}
+	if (exact >= 10000 && error / exact > worstRelative) {
+		worstRelative = error / exact;
+	}
+	if (error > allowed && failures++ < 10) {
+		printf("FAIL %u * 2^%u / %lu = %.0f, exact %.3f\n", numerator, scale,
+				(unsigned long) denominator, result, exact);
+	}
+}
+
+int main(void) {
+
+	static const uint16_t numerators[] = { 1, 2, 3, 100, 1000, 9999, 46875,
+			65534, 65535 };
+
+	for (uint32_t d = 1; d <= 0xFFFF; d++) {
+		for (unsigned i = 0; i < sizeof(numerators) / sizeof(numerators[0]);
+				i++) {
+			check(numerators[i], d, 0);
+		}
+	}
+
+	for (long i = 0; i < RANDOM_PAIRS; i++) {
+		uint16_t numerator = (uint16_t) random32();
+		/* log-uniform denominators cover every magnitude */
+		uint32_t denominator = random32() >> (random32() & 31);
+		uint8_t scale = random32() % 16;
+
+		if (denominator == 0) {
+			continue;
+		}
+		/* results beyond 32 bit are outside the contract */
+		if ((double) numerator * (1UL << scale) / denominator >= 4294967295.0) {
+			continue;
+		}
+		check(numerator, denominator, scale);
+	}
+
+	if (reciprocal_divide(1, 0) != 0xFFFF) {
+		printf("FAIL division by zero\n");
+		failures++;
+	}
+
+	printf("worst error below 10000: %.0f, worst relative error from 10000: "
+			"%.2e, 65535 / 1 = %u\n", worstSmall, worstRelative,
+			reciprocal_divide(65535, 1));
+	printf("%s\n", failures ? "FAILED" : "ok");
+	return failures != 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Task list of ses_scheduler: removing the head, a middle and the last
+ * task, removing a task that is not in the list and adding a removed task
+ * again. The list is observed through the timer 2 tick: only tasks in the
+ * list get their execute flag.
+ */
+#include <stdio.h>
+#include "ses_scheduler.h"
+#include "ses_timer.h"
+
+#define TASKS            4
+
+void TIMER2_COMPA_vect(void);
+
+static taskDescriptor tasks[TASKS];
+static int failures = 0;
+
+static void check(int ok, const char* what, int i) {
+	if (!ok && failures++ < 10) {
+		printf("FAIL %s (%d)\n", what, i);
+	}
+}
+
+void timer2_start(void) {
+}
+
+static void task(void* param) {
+}
+
+/* one tick, then the execute flags show which tasks are in the list */
+static unsigned scheduled(void) {
+
+	unsigned mask = 0;
+
+	for (int i = 0; i < TASKS; i++) {
+		tasks[i].expire = 1;
+		tasks[i].execute = 0;
+	}
+	TIMER2_COMPA_vect();
+	for (int i = 0; i < TASKS; i++) {
+		if (tasks[i].execute) {
+			mask |= 1 << i;
+		}
+	}
+	return mask;
+}
+
+/* empties the list and adds the tasks of mask in index order */
+static void fill(unsigned mask) {
+
+	for (int i = 0; i < TASKS; i++) {
+		scheduler_remove(&tasks[i]);
+	}
+	check(scheduled() == 0, "list not empty", mask);
+	for (int i = 0; i < TASKS; i++) {
+		if (mask & (1 << i)) {
+			check(scheduler_add(&tasks[i]), "add", i);
+		}
+	}
+	check(scheduled() == mask, "fill", mask);
+}
+
+int main(void) {
+
+	for (int i = 0; i < TASKS; i++) {
+		tasks[i].task = &task;
+		tasks[i].period = 1;
+	}
+	scheduler_init();
+
+	/* empty list, NULL and a task that was never added */
+	scheduler_remove(NULL);
+	scheduler_remove(&tasks[0]);
+	check(scheduled() == 0, "empty list", 0);
+
+	/* every task of every list, head, middle and tail included */
+	for (unsigned mask = 1; mask < (1 << TASKS); mask++) {
+		for (int i = 0; i < TASKS; i++) {
+			fill(mask);
+			scheduler_remove(&tasks[i]);
+			check(scheduled() == (mask & ~(1u << i)), "remove", mask * 16 + i);
+		}
+	}
+
+	/* the last task of two, as speedControl_stop removes its task */
+	fill(0x3);
+	scheduler_remove(&tasks[1]);
+	check(scheduled() == 0x1, "remove tail of two", 1);
+
+	/* a removed task can be added again and becomes the tail */
+	fill(0x7);
+	scheduler_remove(&tasks[0]);
+	check(scheduler_add(&tasks[0]), "add again", 0);
+	check(!scheduler_add(&tasks[0]), "add twice", 0);
+	scheduler_remove(&tasks[0]);
+	check(scheduled() == 0x6, "remove re-added tail", 0);
+	scheduler_remove(&tasks[3]);
+	check(scheduled() == 0x6, "remove absent", 3);
+
+	printf("%s\n", failures ? "FAILED" : "ok");
+	return failures != 0;
+}
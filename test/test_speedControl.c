@@ -0,0 +1,141 @@
+/*
+ * ses_speedControl in closed loop with a first-order motor model:
+ * 40 rpm per duty step, 200 ms time constant, and the 40 ms lag of the
+ * median speed measurement. The model runs in 1 ms steps, the controller
+ * every period. Checks settling, overshoot, the rate limit and the
+ * recovery from saturation (anti-windup).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "ses_speedControl.h"
+#include "ses_scheduler.h"
+#include "ses_motorFrequency.h"
+#include "ses_pwm.h"
+
+#define RPM_PER_DUTY     40.0
+#define TIME_CONSTANT_MS 200.0
+#define MEASURE_LAG_MS   40
+
+#define SETTLE_LIMIT_MS  1000
+#define OVERSHOOT_LIMIT  7.0
+
+/* the controller task is not scheduled here, only speedControl_step runs */
+bool scheduler_add(taskDescriptor* td) {
+	return true;
+}
+
+void scheduler_remove(taskDescriptor* td) {
+}
+
+void pwm_setDutyCycle(uint8_t dutyCycle) {
+}
+
+uint16_t motorFrequency_getMedianRpm(void) {
+	return 0;
+}
+
+static int failures = 0;
+
+static double speed = 0;
+static double history[MEASURE_LAG_MS];
+static unsigned long now = 0;
+
+/*
+ * runs the loop from the current state for a number of ms. Returns the
+ * time after which the speed stays within 2 % of the target (-1 if it
+ * does not) and writes the overshoot in the direction of the step in
+ * percent.
+ */
+static long run(uint16_t target, long durationMs, double* overshoot) {
+
+	long settled = -1;
+	uint8_t duty = speedControl_getDuty();
+	int rising = target > speed;
+
+	*overshoot = 0;
+	speedControl_setTarget(target);
+
+	for (long t = 0; t < durationMs; t++, now++) {
+		double deviation;
+
+		if (now % SPEEDCONTROL_DEFAULT_PERIOD_MS == 0) {
+			uint8_t next = speedControl_step(
+					(uint16_t) history[now % MEASURE_LAG_MS]);
+
+			if (abs((int) next - duty) > SPEEDCONTROL_DEFAULT_MAX_STEP) {
+				printf("FAIL duty step %u -> %u\n", duty, next);
+				failures++;
+			}
+			duty = next;
+		}
+
+		/* the measurement seen by the controller lags by MEASURE_LAG_MS */
+		speed += (RPM_PER_DUTY * duty - speed) / TIME_CONSTANT_MS;
+		history[now % MEASURE_LAG_MS] = speed;
+
+		deviation = (speed - target) * 100.0 / target;
+		if (!rising) {
+			deviation = -deviation;
+		}
+		if (deviation > *overshoot) {
+			*overshoot = deviation;
+		}
+		if (deviation > 2.0 || deviation < -2.0) {
+			settled = -1;
+		} else if (settled < 0) {
+			settled = t;
+		}
+	}
+	return settled;
+}
+
+int main(void) {
+
+	static const uint16_t steps[] = { 1500, 8000, 3000, 6000, 1500, 5000 };
+	uint16_t previous = 0;
+	double overshoot;
+	long settled;
+
+	speedControl_init(NULL);
+
+	for (unsigned i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+		settled = run(steps[i], 3000, &overshoot);
+
+		printf("%5u -> %5u rpm: within 2%% after %4ld ms, overshoot %.1f%%\n",
+				previous, steps[i], settled, overshoot);
+		if (settled < 0 || settled > SETTLE_LIMIT_MS
+				|| overshoot > OVERSHOOT_LIMIT) {
+			printf("FAIL step to %u rpm\n", steps[i]);
+			failures++;
+		}
+		previous = steps[i];
+	}
+
+	/*
+	 * 12000 rpm is above the 10200 rpm the model reaches at full duty.
+	 * Without anti-windup the integrator would fill up during the second
+	 * in saturation and delay the step back down.
+	 */
+	run(12000, 1000, &overshoot);
+	if (speedControl_getDuty() != 255) {
+		printf("FAIL no saturation at 12000 rpm\n");
+		failures++;
+	}
+	settled = run(5000, 3000, &overshoot);
+	printf("12000 (saturated) -> 5000 rpm: within 2%% after %ld ms, "
+			"undershoot %.1f%%\n", settled, overshoot);
+	if (settled < 0 || settled > SETTLE_LIMIT_MS
+			|| overshoot > OVERSHOOT_LIMIT) {
+		printf("FAIL windup after saturation\n");
+		failures++;
+	}
+
+	speedControl_setTarget(0);
+	if (speedControl_step(1000) != 0) {
+		printf("FAIL target 0 does not turn the motor off\n");
+		failures++;
+	}
+
+	printf("%s\n", failures ? "FAILED" : "ok");
+	return failures != 0;
+}